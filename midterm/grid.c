@@ -0,0 +1,67 @@
+#include <math.h>
+#include "grid.h"
+
+#define PI 3.141592653589793
+
+typedef double f64v __attribute__((vector_size(GRID_LANES*8)));
+typedef long long i64v __attribute__((vector_size(GRID_LANES*8)));
+
+// constants of the Branin function of pb01
+static const double a = 1, b = 5.1/(4*PI*PI), c = 5/PI;
+static const double r = 6, s = 10, t = 1/(8*PI);
+
+unsigned long long GridPoints(double low, double up, double step)
+{
+    return (unsigned long long)((up - low) / step + 1e-9) + 1;
+}
+
+// mask ? x : y for doubles
+static inline f64v Select(i64v mask, f64v x, f64v y)
+{
+    return (f64v)(((i64v)x & mask) | ((i64v)y & ~mask));
+}
+
+argval BraninRow(double x1, double x2_low, double step, unsigned long long n)
+{
+    const double u = -b*x1*x1 + c*x1 - r;       // x1 terms of the square
+    const double k = s*(1-t)*cos(x1) + s;
+    const unsigned long long full = n / GRID_LANES * GRID_LANES;
+    f64v j, vmin, vidx, x2, f;
+    argval best;
+    unsigned long long i;
+    i64v m;
+    int l;
+
+    // the index is kept as a double, exact up to 2^53, since AVX2 has no
+    // 64 bit integer to double conversion
+    for(l=0; l<GRID_LANES; l++) {
+        j[l] = l;
+        vmin[l] = HUGE_VAL;
+        vidx[l] = 0;
+    }
+    for(i=0; i<full; i+=GRID_LANES) {
+        x2 = x2_low + j*step;
+        f = a*(x2 + u)*(x2 + u) + k;
+        m = f < vmin;
+        vmin = Select(m, f, vmin);
+        vidx = Select(m, j, vidx);
+        j += GRID_LANES;
+    }
+
+    best.val = HUGE_VAL;
+    best.arg = 0;
+    for(l=0; l<GRID_LANES; l++)
+        if(vmin[l] < best.val ||
+           (vmin[l] == best.val && (unsigned long long)vidx[l] < best.arg)) {
+            best.val = vmin[l];
+            best.arg = (unsigned long long)vidx[l];
+        }
+    for(i=full; i<n; i++) {
+        double x = x2_low + (double)i*step, v = a*(x + u)*(x + u) + k;
+        if(v < best.val) {
+            best.val = v;
+            best.arg = i;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,32 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include "slots.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------
+// * Grid search kernels.  BraninRow scans one row x1 = const of the     *
+// * Branin grid of pb01: cos(x1) and the x1 polynomial are evaluated    *
+// * once per row, which leaves the parabola f = a(x2 + u)^2 + k for     *
+// * the x2 sweep.  x2 = x2_low + j*step is computed from the integer    *
+// * index j (no accumulated rounding error) and GRID_LANES points are   *
+// * evaluated at once in GCC vectors, with the argmin kept per lane.    *
+// * On equal values the smallest j wins, as in a scalar scan with '<'.  *
+// -----------------------------------------------------------------------
+
+#define GRID_LANES 8
+
+// number of points low, low+step, ... up to 'up' (inclusive)
+unsigned long long GridPoints(double low, double up, double step);
+
+// minimum of Branin(x1, x2_low + j*step) over j = 0..n-1, arg = j
+argval BraninRow(double x1, double x2_low, double step, unsigned long long n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "gridsearch.h"
+#include "timing.h"
+
+// -----------------------------------------------------------------------
+// * Grid search for the minimum of a built-in objective of objective.h  *
+// * (the maximum of "cubic") in any number of dimensions.  The bounds   *
+// * default to those of the objective, the step to 1/100 of the range.  *
+// * Lists give one value per dimension, a single value is used for all. *
+// * The search is coarse to fine (GridRefine) unless -x is given.       *
+// -----------------------------------------------------------------------
+
+void Usage()
+{
+    printf("Usage: ./grid_nd [options] <cubic|branin|rastrigin|rosenbrock> [dim]\n"
+           "  -n <threads>    number of threads (default 1)\n"
+           "  -m omp|pthread  scheduler (default omp)\n"
+           "  -l <x,x,..>     lower bounds\n"
+           "  -u <x,x,..>     upper bounds\n"
+           "  -s <x,x,..>     steps\n"
+           "  -k <cells>      candidates refined after the coarse search (default 3)\n"
+           "  -x              exhaustive search of the whole grid\n"
+           "The coarse to fine search refines the best local minima of a grid of\n"
+           "at most 10^6 points.  It misses minima narrower than its step and may\n"
+           "stop short in long curved valleys; raise -k or compare with -x.\n");
+    exit(1);
+}
+
+// parse "v1,v2,.." into v[0..dim-1], returns the number of values
+unsigned List(const char *arg, double *v)
+{
+    unsigned k = 0;
+    char *end;
+
+    while (k < GRID_MAX_DIM) {
+        v[k++] = strtod(arg, &end);
+        if (end == arg) Usage();
+        if (*end != ',') break;
+        arg = end + 1;
+    }
+    return k;
+}
+
+// 'cnt' values of a list, or its single value for all 'dim'
+void Expand(double *v, unsigned cnt, unsigned dim)
+{
+    unsigned d;
+    if (cnt == 1)
+        for (d = 1; d < dim; d++)
+            v[d] = v[0];
+    else if (cnt != dim)
+        Usage();
+}
+
+int main(int argc, char *argv[])
+{
+    double lo[GRID_MAX_DIM], hi[GRID_MAX_DIM], step[GRID_MAX_DIM], sec;
+    unsigned nlo = 0, nhi = 0, nstep = 0, dim = 2, d;
+    int threads = 1, mode = GRID_OPENMP, opt, topk = 3;
+    objective *obj;
+    grid_min best;
+    grid g;
+
+    while ((opt = getopt(argc, argv, "n:m:l:u:s:k:x")) != -1) {
+        switch (opt) {
+            case 'n': threads = atoi(optarg); break;
+            case 'm':
+                if (!strcmp(optarg, "omp")) mode = GRID_OPENMP;
+                else if (!strcmp(optarg, "pthread")) mode = GRID_PTHREAD;
+                else Usage();
+                break;
+            case 'l': nlo = List(optarg, lo); break;
+            case 'u': nhi = List(optarg, hi); break;
+            case 's': nstep = List(optarg, step); break;
+            case 'k': topk = atoi(optarg); break;
+            case 'x': topk = 0; break;
+            default: Usage();
+        }
+    }
+    if (argc - optind < 1 || argc - optind > 2 || threads <= 0 || topk < 0)
+        Usage();
+    if (argc - optind > 1) dim = atoi(argv[optind + 1]);
+    if (!(obj = ObjectiveCreate(argv[optind], dim)) || obj->dim > GRID_MAX_DIM)
+        Usage();
+    dim = obj->dim;
+
+    if (nlo) Expand(lo, nlo, dim);
+    else memcpy(lo, obj->lo, dim * sizeof(double));
+    if (nhi) Expand(hi, nhi, dim);
+    else memcpy(hi, obj->hi, dim * sizeof(double));
+    if (nstep) Expand(step, nstep, dim);
+    else
+        for (d = 0; d < dim; d++)
+            step[d] = (hi[d] - lo[d]) / 100;
+    if (!GridSetup(&g, dim, lo, hi, step)) {
+        printf("empty or too large grid\n");
+        exit(1);
+    }
+
+    sec = WallTime();
+    GridRefine(&g, obj, threads, mode, topk, &best);
+    sec = WallTime() - sec;
+
+    printf("%s, %u dimensions, %llu points, %d %s threads, %s\n", obj->name, dim,
+           GridSize(&g), threads, mode == GRID_OPENMP ? "OpenMP" : "pthread",
+           topk ? "coarse to fine" : "exhaustive");
+    printf("%s %.10g at (", obj->minimize ? "minimum" : "maximum", best.val);
+    for (d = 0; d < dim; d++)
+        printf("%s%.6lf", d ? ", " : "", best.x[d]);
+    printf(")\n%llu evaluations, time %.3lf sec, %.2lf M points/sec\n",
+           best.points, sec, best.points / sec / 1e6);
+    ObjectiveRelease(obj);
+    return 0;
+}
@@ -0,0 +1,483 @@
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include <omp.h>
+#include "gridsearch.h"
+#include "grid.h"
+#include "slots.h"
+
+#define GRID_TILE_BYTES (128*1024)    /* coordinates and values of a tile */
+#define GRID_TILES_PER_THREAD 8       /* at least, for the balance        */
+
+typedef struct tag_search{
+    const grid *g;
+    const objective *obj;
+    unsigned long long size;          /* points                       */
+    unsigned long long tile;          /* points per tile              */
+    unsigned long long tiles;
+    unsigned long long next;          /* next tile of the pthreads    */
+    slots best;                       /* argval of each thread        */
+    double *values;                   /* all values, or NULL          */
+}search;
+
+typedef struct tag_worker{
+    search *sr;
+    unsigned id;
+}worker;
+
+// 0 if the grid is empty or too big
+int GridSetup(grid *g, unsigned dim, const double *lo, const double *hi,
+              const double *step)
+{
+    unsigned long long size = 1;
+    unsigned d;
+
+    if(dim == 0 || dim > GRID_MAX_DIM)
+        return 0;
+    g->dim = dim;
+    for(d=0; d<dim; d++) {
+        if(!(step[d] > 0) || !(hi[d] >= lo[d]))
+            return 0;
+        g->lo[d] = lo[d];
+        g->step[d] = step[d];
+        g->n[d] = GridPoints(lo[d], hi[d], step[d]);
+        if(g->n[d] > ~0ull / size)
+            return 0;
+        size *= g->n[d];
+    }
+    return 1;
+}
+
+unsigned long long GridSize(const grid *g)
+{
+    unsigned long long size = 1;
+    unsigned d;
+    for(d=0; d<g->dim; d++)
+        size *= g->n[d];
+    return size;
+}
+
+void GridPoint(const grid *g, unsigned long long index, double *x)
+{
+    unsigned d = g->dim;
+    while(d-- > 0) {
+        x[d] = g->lo[d] + (double)(index % g->n[d]) * g->step[d];
+        index /= g->n[d];
+    }
+}
+
+// -----------------------------------------------------------------------
+// * The coordinates of points first..first+cnt-1, dimension d at        *
+// * x[d*stride].  They are written a row of the last dimension at a     *
+// * time: the other dimensions are constant along a row and the last    *
+// * one is computed from its integer index.                             *
+// -----------------------------------------------------------------------
+
+static void Fill(const grid *g, unsigned long long first,
+                 unsigned long long cnt, unsigned long long stride,
+                 double *x)
+{
+    const unsigned last = g->dim - 1;
+    unsigned long long digit[GRID_MAX_DIM], i = 0, k, run;
+    unsigned d;
+
+    for(d=g->dim; d-- > 0; ) {
+        digit[d] = first % g->n[d];
+        first /= g->n[d];
+    }
+    while(i < cnt) {
+        run = g->n[last] - digit[last];
+        run = run < cnt - i ? run : cnt - i;
+        for(d=0; d<last; d++) {
+            double v = g->lo[d] + (double)digit[d] * g->step[d], *xd = x + d*stride + i;
+            for(k=0; k<run; k++)
+                xd[k] = v;
+        }
+        {
+            double lo = g->lo[last], step = g->step[last], *xd = x + last*stride + i;
+            for(k=0; k<run; k++)
+                xd[k] = lo + (double)(digit[last] + k) * step;
+        }
+        i += run;
+        digit[last] += run;
+        for(d=last; d>0 && digit[d] == g->n[d]; d--) {
+            digit[d] = 0;
+            digit[d-1]++;
+        }
+    }
+}
+
+// evaluate tile 't' and merge its argmin into 'best'
+static void Tile(search *sr, unsigned long long t, double *x, double *f,
+                 argval *best)
+{
+    const objective *obj = sr->obj;
+    const unsigned long long first = t * sr->tile;
+    const unsigned long long cnt = sr->size - first < sr->tile ?
+                                   sr->size - first : sr->tile;
+    const double sign = obj->minimize ? 1.0 : -1.0;
+    unsigned long long i, k = 0;
+    argval b;
+
+    if(sr->values)
+        f = sr->values + first;
+    Fill(sr->g, first, cnt, sr->tile, x);
+    obj->eval(x, sr->tile, sr->g->dim, cnt, f, obj->data);
+    for(i=1; i<cnt; i++)
+        if(sign * f[i] < sign * f[k])
+            k = i;
+    b.val = sign * f[k];
+    b.arg = first + k;
+    ArgMin(best, &b);
+}
+
+static void* threadTiles(void *arg)
+{
+    worker *w = (worker*)arg;
+    search *sr = w->sr;
+    double *x = (double*)malloc(sr->tile * (sr->g->dim + 1) * sizeof(double));
+    argval *mine = (argval*)Slot(&sr->best, w->id);
+    unsigned long long t;
+
+    while((t = __atomic_fetch_add(&sr->next, 1, __ATOMIC_RELAXED)) < sr->tiles)
+        Tile(sr, t, x, x + sr->tile * sr->g->dim, mine);
+    free(x);
+    return NULL;
+}
+
+// cut the points of sr->g into tiles for 'threads' threads
+static void Tiles(search *sr, int threads)
+{
+    const grid *g = sr->g;
+    unsigned long long per_thread;
+
+    sr->size = GridSize(g);
+    sr->tile = GRID_TILE_BYTES / (sizeof(double) * (g->dim + 1));
+    per_thread = sr->size / ((unsigned long long)threads * GRID_TILES_PER_THREAD);
+    if(threads > 1 && per_thread < sr->tile)
+        sr->tile = per_thread;
+    sr->tile = sr->tile / GRID_LANES * GRID_LANES;
+    if(sr->tile < GRID_LANES)
+        sr->tile = GRID_LANES;
+    sr->tiles = (sr->size + sr->tile - 1) / sr->tile;
+    sr->next = 0;
+}
+
+// argmin of all points of 'g' by the calling thread alone
+static argval SearchSerial(const grid *g, const objective *obj)
+{
+    search sr;
+    argval best;
+    unsigned long long t;
+    double *x;
+
+    sr.g = g;
+    sr.obj = obj;
+    sr.values = NULL;
+    Tiles(&sr, 1);
+    x = (double*)malloc(sr.tile * (g->dim + 1) * sizeof(double));
+    best.val = HUGE_VAL;
+    best.arg = ~0ull;
+    for(t=0; t<sr.tiles; t++)
+        Tile(&sr, t, x, x + sr.tile * g->dim, &best);
+    free(x);
+    return best;
+}
+
+// evaluate all tiles of 'sr' with 'threads' threads, returns the argmin
+static argval Run(search *sr, int threads, int mode)
+{
+    const grid *g = sr->g;
+    argval best;
+    long i;
+
+    Tiles(sr, threads);
+    SlotsInit(&sr->best, threads, sizeof(argval));
+    for(i=0; i<threads; i++) {
+        argval *b = (argval*)Slot(&sr->best, i);
+        b->val = HUGE_VAL;
+        b->arg = ~0ull;
+    }
+
+    if(mode == GRID_OPENMP) {
+#pragma omp parallel num_threads(threads)
+        {
+            double *x = (double*)malloc(sr->tile * (g->dim + 1) * sizeof(double));
+            argval *mine = (argval*)Slot(&sr->best, omp_get_thread_num());
+            unsigned long long t;
+#pragma omp for schedule(dynamic)
+            for(t=0; t<sr->tiles; t++)
+                Tile(sr, t, x, x + sr->tile * g->dim, mine);
+            free(x);
+        }
+    }
+    else {
+        pthread_t *thread_p = (pthread_t*)malloc(threads * sizeof(pthread_t));
+        worker *w = (worker*)malloc(threads * sizeof(worker));
+        for(i=0; i<threads; i++) {
+            w[i].sr = sr;
+            w[i].id = i;
+            pthread_create(&thread_p[i], NULL, threadTiles, &w[i]);
+        }
+        for(i=0; i<threads; i++)
+            pthread_join(thread_p[i], NULL);
+        free(thread_p);
+        free(w);
+    }
+
+    best.val = HUGE_VAL;
+    best.arg = ~0ull;
+    SlotsMerge(&sr->best, &best, ArgMin);
+    SlotsRelease(&sr->best);
+    return best;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void GridSearch(const grid *g, const objective *obj, int threads, int mode,
+                grid_min *out)
+{
+    search sr;
+    argval best;
+
+    sr.g = g;
+    sr.obj = obj;
+    sr.values = NULL;
+    best = Run(&sr, threads, mode);
+    out->val = obj->minimize ? best.val : -best.val;
+    out->index = best.arg;
+    GridPoint(g, best.arg, out->x);
+    out->points = sr.size;
+}
+
+// the values of all points of 'g' into f[0..GridSize-1]
+void GridValues(const grid *g, const objective *obj, int threads, int mode,
+                double *f)
+{
+    search sr;
+
+    sr.g = g;
+    sr.obj = obj;
+    sr.values = f;
+    Run(&sr, threads, mode);
+}
+
+// -----------------------------------------------------------------------
+// * Coarse to fine search.  The coarse grid takes every m-th point of   *
+// * each dimension of 'g', m a power of 2 such that it has at most      *
+// * GRID_COARSE_POINTS points.  Its local minima (no neighbour along an *
+// * axis is better) are the candidates, and the 'topk' best of them are *
+// * refined independently: the box of +-m points of 'g' around a        *
+// * candidate is searched with every m/2-th point, the box around the   *
+// * best of those with every m/4-th point and so on down to the step of *
+// * 'g'.  A best point on a face of its box moves the box and searches  *
+// * again, one inside is checked with boxes 2 and 4 times as wide.  The *
+// * boxes are small (5 to 17 points per dimension), so a candidate is   *
+// * refined by one thread and the threads take the candidates           *
+// * dynamically (OpenMP or an atomic counter).  This is a local search: *
+// * it misses a global minimum whose basin is narrower than the coarse  *
+// * step, and may stop short in a valley that bends more sharply than   *
+// * its widest box; topk = 0 searches the whole grid.                   *
+// -----------------------------------------------------------------------
+
+#define GRID_COARSE_POINTS 1000000
+
+typedef struct tag_refine{
+    const grid *g, *coarse;
+    const objective *obj;
+    unsigned long long m;             /* coarse step in fine steps    */
+    const argval *cand;               /* coarse points to refine      */
+    unsigned cnt;
+    unsigned next;                    /* next candidate of pthreads   */
+    unsigned long long *index;        /* result of each candidate     */
+    unsigned long long *points;       /* points it evaluated          */
+}refine;
+
+// the 'topk' best local minima of the values 'f' of grid 'g'
+static unsigned LocalMinima(const grid *g, const double *f, double sign,
+                            unsigned topk, argval *cand)
+{
+    const unsigned long long size = GridSize(g);
+    unsigned long long p, q, rest, stride[GRID_MAX_DIM], digit;
+    unsigned d, k = 0, j;
+    argval c;
+
+    stride[g->dim-1] = 1;
+    for(d=g->dim-1; d>0; d--)
+        stride[d-1] = stride[d] * g->n[d];
+    for(p=0; p<size; p++) {
+        c.val = sign * f[p];
+        c.arg = p;
+        for(d=0, rest=p; d<g->dim; d++) {
+            digit = rest / stride[d];
+            rest %= stride[d];
+            q = p - stride[d];
+            if(digit > 0 && sign * f[q] < c.val)
+                break;
+            q = p + stride[d];
+            if(digit + 1 < g->n[d] && sign * f[q] < c.val)
+                break;
+        }
+        if(d < g->dim || (k == topk && c.val >= cand[k-1].val))
+            continue;
+        j = k < topk ? k++ : k - 1;           // insertion into cand[0..k-1]
+        while(j > 0 && cand[j-1].val > c.val) {
+            cand[j] = cand[j-1];
+            j--;
+        }
+        cand[j] = c;
+    }
+    return k;
+}
+
+// refine candidate 'k' down to the fine grid, serially
+static void RefineOne(refine *rf, unsigned k)
+{
+    const grid *g = rf->g;
+    unsigned long long J[GRID_MAX_DIM], lo[GRID_MAX_DIM], hi[GRID_MAX_DIM];
+    unsigned long long mm, half, rest, pos, points = 0;
+    unsigned d, face, wide = 2;
+    double last = HUGE_VAL;
+    argval r;
+    grid box;
+
+    // fine indices of the candidate
+    box.dim = g->dim;
+    for(d=g->dim, rest=rf->cand[k].arg; d-- > 0; ) {
+        J[d] = rest % rf->coarse->n[d] * rf->m;
+        rest /= rf->coarse->n[d];
+    }
+    for(mm=rf->m; mm>1; ) {
+        half = wide * (mm / 2);
+        for(d=0; d<g->dim; d++) {
+            lo[d] = J[d] > half ? J[d] - half : 0;
+            hi[d] = J[d] + half < g->n[d] - 1 ? J[d] + half : g->n[d] - 1;
+            box.lo[d] = g->lo[d] + (double)lo[d] * g->step[d];
+            box.step[d] = g->step[d] * (mm / 2);
+            box.n[d] = (hi[d] - lo[d]) / (mm / 2) + 1;
+        }
+        r = SearchSerial(&box, rf->obj);
+        points += GridSize(&box);
+        for(d=g->dim, rest=r.arg, face=0; d-- > 0; ) {
+            pos = rest % box.n[d];
+            rest /= box.n[d];
+            J[d] = lo[d] + pos * (mm / 2);
+            if ((pos == 0 && lo[d] > 0) ||
+                (pos == box.n[d] - 1 && hi[d] < g->n[d] - 1))
+                face = 1;
+        }
+        // a best point on a face of the box (not of the grid) means the
+        // minimum lies outside: move the box there at the same spacing,
+        // as long as the value keeps going down.  A best point inside is
+        // checked with boxes 2 and 4 times as wide before the spacing
+        // halves, in curved valleys (rosenbrock) the small box stops short.
+        if (r.val < last && (face || wide > 2)) {
+            last = r.val;
+            wide = 2;
+        }
+        else if (wide < 8) {
+            if (r.val < last)
+                last = r.val;
+            wide *= 2;
+        }
+        else {
+            wide = 2;
+            mm /= 2;
+        }
+    }
+    for(d=0, rf->index[k]=0; d<g->dim; d++)
+        rf->index[k] = rf->index[k] * g->n[d] + J[d];
+    rf->points[k] = points;
+}
+
+static void* threadRefine(void *arg)
+{
+    refine *rf = (refine*)arg;
+    unsigned k;
+
+    while((k = __atomic_fetch_add(&rf->next, 1, __ATOMIC_RELAXED)) < rf->cnt)
+        RefineOne(rf, k);
+    return NULL;
+}
+
+void GridRefine(const grid *g, const objective *obj, int threads, int mode,
+                unsigned topk, grid_min *out)
+{
+    const double sign = obj->minimize ? 1.0 : -1.0;
+    unsigned long long m = 1, size;
+    unsigned k, cnt, d;
+    argval *cand, best;
+    grid coarse;
+    refine rf;
+    double *f, x[GRID_MAX_DIM], v;
+    long i;
+
+    for(;;) {
+        for(d=0, size=1; d<g->dim; d++)
+            size *= (g->n[d] - 1) / m + 1;
+        if(size <= GRID_COARSE_POINTS)
+            break;
+        m *= 2;
+    }
+    if(topk == 0 || m == 1) {
+        GridSearch(g, obj, threads, mode, out);
+        return;
+    }
+
+    coarse.dim = g->dim;
+    for(d=0; d<g->dim; d++) {
+        coarse.lo[d] = g->lo[d];
+        coarse.step[d] = g->step[d] * m;
+        coarse.n[d] = (g->n[d] - 1) / m + 1;
+    }
+    f = (double*)malloc(size * sizeof(double));
+    GridValues(&coarse, obj, threads, mode, f);
+    cand = (argval*)malloc(topk * sizeof(argval));
+    cnt = LocalMinima(&coarse, f, sign, topk, cand);
+    out->points = size;
+    free(f);
+
+    rf.g = g;
+    rf.coarse = &coarse;
+    rf.obj = obj;
+    rf.m = m;
+    rf.cand = cand;
+    rf.cnt = cnt;
+    rf.next = 0;
+    rf.index = (unsigned long long*)malloc(cnt * sizeof(unsigned long long));
+    rf.points = (unsigned long long*)malloc(cnt * sizeof(unsigned long long));
+    if(threads > (int)cnt)
+        threads = cnt ? cnt : 1;
+    if(mode == GRID_OPENMP) {
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+        for(k=0; k<cnt; k++)
+            RefineOne(&rf, k);
+    }
+    else {
+        pthread_t *thread_p = (pthread_t*)malloc(threads * sizeof(pthread_t));
+        for(i=0; i<threads; i++)
+            pthread_create(&thread_p[i], NULL, threadRefine, &rf);
+        for(i=0; i<threads; i++)
+            pthread_join(thread_p[i], NULL);
+        free(thread_p);
+    }
+
+    // in candidate order, so the result does not depend on the schedule
+    best.val = HUGE_VAL;
+    best.arg = ~0ull;
+    for(k=0; k<cnt; k++) {
+        GridPoint(g, rf.index[k], x);
+        v = sign * ObjectiveValue(obj, x);
+        if(v < best.val || (v == best.val && rf.index[k] < best.arg)) {
+            best.val = v;
+            best.arg = rf.index[k];
+        }
+        out->points += rf.points[k];
+    }
+    free(rf.index);
+    free(rf.points);
+    free(cand);
+    out->val = sign * best.val;
+    out->index = best.arg;
+    GridPoint(g, best.arg, out->x);
+}
@@ -0,0 +1,58 @@
+#ifndef GRIDSEARCH_H
+#define GRIDSEARCH_H
+
+#include "objective.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------
+// * Parallel grid search over D dimensions.  Dimension d has the n[d]   *
+// * points lo[d] + j*step[d], and the points are numbered with the last *
+// * dimension fastest.  The index space is cut into tiles of            *
+// * consecutive points, small enough that the coordinates and values of *
+// * a tile stay in the L2 cache and many enough that every thread gets  *
+// * several.  The tiles are handed out dynamically, by OpenMP or by an  *
+// * atomic counter shared by pthreads, and each tile is one batch for   *
+// * the objective (objective.h).  Every thread keeps its argmin in its  *
+// * own slot (slots.h).  On equal values the smallest index wins, so    *
+// * the result does not depend on the schedule.                         *
+// *                                                                     *
+// * GridRefine searches coarse to fine instead, see gridsearch.c.       *
+// -----------------------------------------------------------------------
+
+#define GRID_MAX_DIM 16
+
+enum { GRID_OPENMP, GRID_PTHREAD };
+
+typedef struct tag_grid{
+    unsigned dim;
+    double lo[GRID_MAX_DIM];             /* first point               */
+    double step[GRID_MAX_DIM];
+    unsigned long long n[GRID_MAX_DIM];  /* points per dimension      */
+}grid;
+
+typedef struct tag_grid_min{
+    double val;                          /* best objective value      */
+    unsigned long long index;            /* its point                 */
+    double x[GRID_MAX_DIM];
+    unsigned long long points;           /* points evaluated          */
+}grid_min;
+
+int    GridSetup(grid *g, unsigned dim, const double *lo, const double *hi,
+                 const double *step);
+unsigned long long GridSize(const grid *g);
+void   GridPoint(const grid *g, unsigned long long index, double *x);
+void   GridSearch(const grid *g, const objective *obj, int threads, int mode,
+                  grid_min *out);
+void   GridValues(const grid *g, const objective *obj, int threads, int mode,
+                  double *f);
+void   GridRefine(const grid *g, const objective *obj, int threads, int mode,
+                  unsigned topk, grid_min *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "monitor.h"
+#include "timing.h"
+
+const char *pso_reason[] = {
+    "running", "iteration limit", "stagnation", "target reached",
+    "time budget", "swarm diameter" };
+
+void StopDefault(pso_stop *stop, unsigned long long max_itera)
+{
+    stop->max_itera = max_itera;
+    stop->stall = 0;
+    stop->tol = 0.0;
+    stop->target = NAN;
+    stop->budget = 0.0;
+    stop->diameter = 0.0;
+}
+
+// one option of PSO_STOP_OPTIONS, returns 0 if 'opt' is none of them
+int StopOption(pso_stop *stop, int opt, const char *arg)
+{
+    switch(opt) {
+        case 'i': stop->max_itera = strtoull(arg, 0, 10); break;
+        case 'g': stop->stall = strtoull(arg, 0, 10); break;
+        case 'e': stop->tol = atof(arg); break;
+        case 'f': stop->target = atof(arg); break;
+        case 'b': stop->budget = atof(arg); break;
+        case 'd': stop->diameter = atof(arg); break;
+        default: return 0;
+    }
+    return 1;
+}
+
+// largest extent of the particles in any dimension relative to the bounds
+double SwarmDiameter(const swarm *s)
+{
+    unsigned i, d;
+    double diam = 0.0;
+
+    for(d=0; d<s->dim; d++) {
+        const double *x = s->pos + (size_t)d * s->stride;
+        double lo = x[0], hi = x[0];
+        for(i=1; i<s->cnt; i++) {
+            lo = x[i] < lo ? x[i] : lo;
+            hi = x[i] > hi ? x[i] : hi;
+        }
+        hi = (hi - lo) / (s->obj->hi[d] - s->obj->lo[d]);
+        diam = hi > diam ? hi : diam;
+    }
+    return diam;
+}
+
+static void Sample(pso_monitor *m, const swarm *s, unsigned long long iter,
+                   double now)
+{
+    if(m->trace_cnt == m->trace_cap) {
+        m->trace_cap = m->trace_cap ? 2 * m->trace_cap : 1024;
+        m->trace = (pso_sample*)realloc(m->trace, m->trace_cap * sizeof(pso_sample));
+    }
+    m->trace[m->trace_cnt].iter = iter;
+    m->trace[m->trace_cnt].value = SwarmBestValue(s);
+    m->trace[m->trace_cnt].wall = now;
+    m->trace_cnt++;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// start monitoring the initialized swarm 's'
+void MonitorInit(pso_monitor *m, const pso_stop *stop,
+                 unsigned long long period, const swarm *s)
+{
+    m->stop = *stop;
+    m->period = period;
+    m->start = WallTime();
+    m->last_fit = s->gbest_fit;
+    m->last_iter = m->iter = 0;
+    m->reason = PSO_RUNNING;
+    m->trace = NULL;
+    m->trace_cnt = m->trace_cap = 0;
+    Sample(m, s, 0, 0.0);
+}
+
+// check the criteria after 'iter' iterations, returns the reason to stop
+int MonitorCheck(pso_monitor *m, const swarm *s, unsigned long long iter)
+{
+    const pso_stop *st = &m->stop;
+    const double now = WallTime() - m->start;
+    const double target = s->obj->minimize ? -st->target : st->target;
+    const int improved = s->gbest_fit > m->last_fit;
+
+    m->iter = iter;
+    if(improved || (m->period && iter % m->period == 0))
+        Sample(m, s, iter, now);
+    if(s->gbest_fit > m->last_fit + st->tol) {
+        m->last_fit = s->gbest_fit;
+        m->last_iter = iter;
+    }
+
+    if(s->gbest_fit >= target)
+        m->reason = PSO_TARGET;
+    else if(iter >= st->max_itera)
+        m->reason = PSO_MAX_ITERA;
+    else if(st->stall && iter - m->last_iter >= st->stall)
+        m->reason = PSO_STAGNATION;
+    else if(st->budget > 0 && now >= st->budget)
+        m->reason = PSO_BUDGET;
+    else if(st->diameter > 0 && SwarmDiameter(s) < st->diameter)
+        m->reason = PSO_DIAMETER;
+    if(m->reason != PSO_RUNNING &&
+       m->trace[m->trace_cnt-1].iter != iter)
+        Sample(m, s, iter, now);
+    return m->reason;
+}
+
+// write the telemetry to 'path' ("-": stdout) as lines
+// "iteration value seconds", returns 0 on error
+int MonitorWrite(const pso_monitor *m, const char *path)
+{
+    FILE *f = strcmp(path, "-") ? fopen(path, "w") : stdout;
+    unsigned i;
+
+    if(!f) {
+        perror(path);
+        return 0;
+    }
+    for(i=0; i<m->trace_cnt; i++)
+        fprintf(f, "%llu %.17g %.6f\n", m->trace[i].iter, m->trace[i].value,
+                m->trace[i].wall);
+    if(f != stdout)
+        fclose(f);
+    return 1;
+}
+
+void MonitorRelease(pso_monitor *m)
+{
+    free(m->trace);
+}
@@ -0,0 +1,85 @@
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#include "pso.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------
+// * Stopping criteria and progress telemetry of a swarm.  MonitorCheck  *
+// * is called by one thread whenever gbest has been updated, i.e. at    *
+// * the merge points of the parallel drivers, and returns why the run   *
+// * should stop or PSO_RUNNING.  A run stops at the first of:           *
+// *   max_itera  iterations done                                        *
+// *   stall      iterations without gbest improving by more than 'tol'  *
+// *   target     objective value reached (NAN: off)                     *
+// *   budget     seconds of wall time                                   *
+// *   diameter   largest extent of the swarm in any dimension, relative *
+// *              to the bounds (costs a pass over the positions)        *
+// * The other criteria are off if they are 0.                           *
+// *                                                                     *
+// * Telemetry: a sample (iteration, gbest value, wall time) is kept     *
+// * whenever gbest improves and every 'period' iterations, in memory    *
+// * only, and written to a file by MonitorWrite after the run.          *
+// -----------------------------------------------------------------------
+
+enum { PSO_RUNNING, PSO_MAX_ITERA, PSO_STAGNATION, PSO_TARGET, PSO_BUDGET,
+       PSO_DIAMETER };
+
+extern const char *pso_reason[];
+
+typedef struct tag_pso_stop{
+    unsigned long long max_itera;  /* maximum number of iterations      */
+    unsigned long long stall;      /* stagnation window in iterations   */
+    double tol;                    /* smallest improvement for 'stall'  */
+    double target;                 /* objective value to reach          */
+    double budget;                 /* time budget in seconds            */
+    double diameter;               /* relative swarm diameter           */
+}pso_stop;
+
+typedef struct tag_pso_sample{
+    unsigned long long iter;
+    double value;                  /* objective value of gbest          */
+    double wall;                   /* seconds since MonitorInit         */
+}pso_sample;
+
+typedef struct tag_pso_monitor{
+    pso_stop stop;
+    unsigned long long period;     /* sampling period, 0: improvements  */
+    double start;
+    double last_fit;               /* gbest fitness of last improvement */
+    unsigned long long last_iter;  /* iteration of last improvement     */
+    unsigned long long iter;       /* iterations done at the last check */
+    int reason;
+    pso_sample *trace;
+    unsigned trace_cnt, trace_cap;
+}pso_monitor;
+
+// command line options of the criteria, parsed by StopOption
+#define PSO_STOP_OPTIONS "i:g:e:f:b:d:"
+#define PSO_STOP_USAGE \
+    "  -i <iterations> maximum iterations\n" \
+    "  -g <iterations> stop after that many iterations without improvement\n" \
+    "  -e <tolerance>  smaller improvements do not count for -g\n" \
+    "  -f <value>      stop when the objective value is reached\n" \
+    "  -b <seconds>    time budget\n" \
+    "  -d <diameter>   stop when the swarm is that small (0..1)\n"
+
+void   StopDefault(pso_stop *stop, unsigned long long max_itera);
+int    StopOption(pso_stop *stop, int opt, const char *arg);
+
+void   MonitorInit(pso_monitor *m, const pso_stop *stop,
+                   unsigned long long period, const swarm *s);
+int    MonitorCheck(pso_monitor *m, const swarm *s, unsigned long long iter);
+int    MonitorWrite(const pso_monitor *m, const char *path);
+void   MonitorRelease(pso_monitor *m);
+
+double SwarmDiameter(const swarm *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
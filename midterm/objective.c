@@ -0,0 +1,124 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "objective.h"
+
+#define PI 3.141592653589793
+
+// x**3 - 0.8x**2 - 10000x + 8000 of pb02
+static void Cubic(const double *restrict x, unsigned stride, unsigned dim,
+                  unsigned cnt, double *restrict f, void *data)
+{
+    unsigned i;
+    for(i=0; i<cnt; i++)
+        f[i] = fabs(8000.0 + x[i]*(-10000.0+x[i]*(-0.8+x[i])));
+}
+
+// a(x2 - b x1^2 + c x1 - r)^2 + s(1-t)cos(x1) + s, the function of pb01
+static void Branin(const double *restrict x, unsigned stride, unsigned dim,
+                   unsigned cnt, double *restrict f, void *data)
+{
+    const double a = 1, b = 5.1/(4*PI*PI), c = 5/PI;
+    const double r = 6, s = 10, t = 1/(8*PI);
+    const double *x1 = x, *x2 = x + stride;
+    unsigned i;
+
+    for(i=0; i<cnt; i++) {
+        double u = x2[i] - b*x1[i]*x1[i] + c*x1[i] - r;
+        f[i] = a*u*u + s*(1-t)*cos(x1[i]) + s;
+    }
+}
+
+// 10D + sum of x_d^2 - 10cos(2 pi x_d), minimum 0 at the origin
+static void Rastrigin(const double *restrict x, unsigned stride, unsigned dim,
+                      unsigned cnt, double *restrict f, void *data)
+{
+    unsigned i, d;
+
+    for(i=0; i<cnt; i++)
+        f[i] = 10.0 * dim;
+    for(d=0; d<dim; d++) {
+        const double *xd = x + (size_t)d * stride;
+        for(i=0; i<cnt; i++)
+            f[i] += xd[i]*xd[i] - 10.0*cos(2*PI*xd[i]);
+    }
+}
+
+// sum of 100(x_d+1 - x_d^2)^2 + (1 - x_d)^2, minimum 0 at (1,..,1)
+static void Rosenbrock(const double *restrict x, unsigned stride, unsigned dim,
+                       unsigned cnt, double *restrict f, void *data)
+{
+    unsigned i, d;
+
+    for(i=0; i<cnt; i++)
+        f[i] = 0.0;
+    for(d=0; d+1<dim; d++) {
+        const double *xd = x + (size_t)d * stride, *xn = xd + stride;
+        for(i=0; i<cnt; i++) {
+            double u = xn[i] - xd[i]*xd[i], v = 1.0 - xd[i];
+            f[i] += 100.0*u*u + v*v;
+        }
+    }
+}
+
+#define BOUNDS 2           /* bounds given per built-in objective */
+
+static const struct {
+    const char *name;
+    unsigned dim;          /* 0: any number of dimensions */
+    int minimize;
+    double lo[BOUNDS], hi[BOUNDS];  /* the last repeats in further dims */
+    pso_eval eval;
+} builtin[] = {
+    { "cubic",      1, 0, { -100.0          }, { 100.0         }, Cubic      },
+    { "branin",     2, 1, {   -5.0,   0.0   }, {  10.0,  15.0  }, Branin     },
+    { "rastrigin",  0, 1, {  -5.12,  -5.12  }, {  5.12,  5.12  }, Rastrigin  },
+    { "rosenbrock", 0, 1, {   -5.0,  -5.0   }, {  10.0,  10.0  }, Rosenbrock },
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// built-in objective 'name' over 'dim' dimensions, NULL if unknown
+objective* ObjectiveCreate(const char *name, unsigned dim)
+{
+    objective *obj;
+    unsigned k, d;
+
+    for(k=0; k<sizeof builtin / sizeof builtin[0]; k++)
+        if(!strcmp(name, builtin[k].name))
+            break;
+    if(k == sizeof builtin / sizeof builtin[0])
+        return NULL;
+    if(builtin[k].dim)
+        dim = builtin[k].dim;
+    if(!dim)
+        return NULL;
+
+    obj = (objective*)calloc(1, sizeof(objective));
+    obj->name = builtin[k].name;
+    obj->dim = dim;
+    obj->minimize = builtin[k].minimize;
+    obj->eval = builtin[k].eval;
+    obj->lo = (double*)malloc(dim * sizeof(double));
+    obj->hi = (double*)malloc(dim * sizeof(double));
+    for(d=0; d<dim; d++) {
+        obj->lo[d] = builtin[k].lo[d < BOUNDS ? d : BOUNDS - 1];
+        obj->hi[d] = builtin[k].hi[d < BOUNDS ? d : BOUNDS - 1];
+    }
+    return obj;
+}
+
+void ObjectiveRelease(objective *obj)
+{
+    free(obj->lo);
+    free(obj->hi);
+    free(obj);
+}
+
+// value of the single point x[0..dim-1]
+double ObjectiveValue(const objective *obj, const double *x)
+{
+    double f;
+    obj->eval(x, 1, obj->dim, 1, &f, obj->data);
+    return f;
+}
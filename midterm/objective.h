@@ -0,0 +1,44 @@
+#ifndef OBJECTIVE_H
+#define OBJECTIVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------
+// * Objective functions of the swarm (pso.h), evaluated in batches:     *
+// * 'eval' gets the positions of 'cnt' particles, coordinate d of       *
+// * particle i at x[d*stride + i], and writes their values to f[0..cnt- *
+// * 1].  Loops over the particles of a batch vectorize and an expensive *
+// * objective can spread a batch over its own resources.  The swarm     *
+// * maximizes, with 'minimize' set it maximizes the negated value.      *
+// *                                                                     *
+// * ObjectiveCreate makes the built-in objectives by name:              *
+// *   cubic       1-D |x^3 - 0.8x^2 - 10000x + 8000| of pb02, maximized *
+// *   branin      2-D Branin function of pb01                           *
+// *   rastrigin   D-dimensional Rastrigin function                      *
+// *   rosenbrock  D-dimensional Rosenbrock function                     *
+// * Other objectives are set up by filling in the structure.            *
+// -----------------------------------------------------------------------
+
+typedef void (*pso_eval)(const double *x, unsigned stride, unsigned dim,
+                         unsigned cnt, double *f, void *data);
+
+typedef struct tag_objective{
+    const char *name;
+    unsigned dim;          /* number of dimensions                 */
+    int minimize;          /* minimize instead of maximize         */
+    double *lo, *hi;       /* bounds of each dimension             */
+    pso_eval eval;         /* batched evaluation                   */
+    void *data;            /* passed to 'eval'                     */
+}objective;
+
+objective* ObjectiveCreate(const char *name, unsigned dim);
+void   ObjectiveRelease(objective *obj);
+double ObjectiveValue(const objective *obj, const double *x);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "grid.h"
+#include "timing.h"
+
+// -----------------------------------------------------------------------
+// * Single thread throughput of the Branin grid search of pb01: the     *
+// * original loop (pow and cos for every point, accumulated x2) against *
+// * BraninRow of grid.c, over every k-th row of the 15000 x1 rows.      *
+// * Usage: ./pb01_bench [k]                                             *
+// -----------------------------------------------------------------------
+
+#define pi  3.141592653589793
+double a = 1, b = 5.1/(4*pi*pi), c = 5/pi, r = 6, s = 10, t = 1/(8*pi);
+double x1_low = -5, x2_low = 0, x2_up = 15, step = 1E-3;
+
+// the loop of pb01_ptd.cpp
+double Scalar(int k, double *min_x1, double *min_x2, double *points)
+{
+    double x1, x2, temp, min = HUGE_VAL;
+    int i;
+
+    *points = 0;
+    for(i = 0; i < 15000; i += k){
+        x1 = x1_low + (double) i * step;
+        for(x2= x2_low; x2<= x2_up; x2+=step){
+            temp = a*pow((x2-b*x1*x1 + c*x1 -r),2)+s*(1-t)*cos(x1) +s;
+            if(temp < min){
+                *min_x1 = x1;
+                *min_x2 = x2;
+                min = temp;
+            }
+            *points += 1;
+        }
+    }
+    return min;
+}
+
+double Vector(int k, double *min_x1, double *min_x2, double *points)
+{
+    unsigned long long n2 = GridPoints(x2_low, x2_up, step);
+    double x1, min = HUGE_VAL;
+    argval row;
+    int i;
+
+    *points = 0;
+    for(i = 0; i < 15000; i += k){
+        x1 = x1_low + (double) i * step;
+        row = BraninRow(x1, x2_low, step, n2);
+        if(row.val < min){
+            *min_x1 = x1;
+            *min_x2 = x2_low + (double)row.arg * step;
+            min = row.val;
+        }
+        *points += n2;
+    }
+    return min;
+}
+
+int main(int argc, char *argv[])
+{
+    int k = 10;
+    double start, sec1, sec2, min1, min2, x1a, x2a, x1b, x2b, p1, p2;
+
+    if (argc > 1) k = atoi(argv[1]);
+    if (argc > 2 || k <= 0) {
+        printf("Usage: ./pb01_bench [k]\n");
+        exit(1);
+    }
+
+    start = WallTime();
+    min1 = Scalar(k, &x1a, &x2a, &p1);
+    sec1 = WallTime() - start;
+    start = WallTime();
+    min2 = Vector(k, &x1b, &x2b, &p2);
+    sec2 = WallTime() - start;
+
+    printf("every %d. row, %.0lf points\n", k, p2);
+    printf("scalar    : %8.3lf sec %9.2lf M points/sec  fit(%.6lf,%.6lf) = %.10lf\n",
+           sec1, p1 / sec1 / 1e6, x1a, x2a, min1);
+    printf("BraninRow : %8.3lf sec %9.2lf M points/sec  fit(%.6lf,%.6lf) = %.10lf\n",
+           sec2, p2 / sec2 / 1e6, x1b, x2b, min2);
+    printf("speedup   : %8.2lf\n", (p2 / sec2) / (p1 / sec1));
+    return 0;
+}
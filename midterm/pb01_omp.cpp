@@ -2,7 +2,9 @@
 #include <stdlib.h>
 #include <omp.h>
 #include <math.h>
-#include <time.h>
+#include "slots.h"
+#include "timing.h"
+#include "grid.h"
 using namespace std;
 #define pi  3.141592653589793
 double a=1;
@@ -18,6 +20,19 @@ double fit(double x1,double x2) {
     return a*pow((x2-b*x1*x1 + c*x1 -r),2)+s*(1-t)*cos(x1) +s;
 }
 
+// minimum found by one thread, kept in its own slot (slots.h)
+typedef struct tag_gridmin{
+    double val, x1, x2;
+}gridmin;
+
+// on equal values the lower thread, which scanned smaller x1, wins
+void GridMinMerge(void *best, const void *other) {
+    gridmin *b = (gridmin *) best;
+    const gridmin *o = (const gridmin *) other;
+    if (o->val < b->val)
+        *b = *o;
+}
+
 int main(int argc, char *argv[]){
     if (argc !=2) {
         cout << "Usage: 1pbomp [num]" << endl;
@@ -31,53 +46,59 @@ int main(int argc, char *argv[]){
     x2_low = 0;
     x2_up = 15;	
     double step = 1E-3;
-    double min_x1,min_x2,min;
-
-    double *themin = (double *) malloc(thread_num * sizeof(double));
-    double *min_1 = (double *) malloc(thread_num * sizeof(double));
-    double *min_2 = (double *) malloc(thread_num * sizeof(double));
+    unsigned long long n2 = GridPoints(x2_low, x2_up, step);
+    double min;
+    gridmin best;
+    slots mins;
+    timing tm;
 
     min = fit(x1_low ,x2_low);
-    clock_t start,end;
-    start = clock();
+    SlotsInit(&mins, thread_num, sizeof(gridmin));
+    for (int i = 0; i < thread_num; i++) {
+        gridmin *m = (gridmin *) Slot(&mins, i);
+        m->val = min;
+        m->x1 = x1_low;
+        m->x2 = x2_low;
+    }
+    TimingInit(&tm, "pb01_omp", thread_num);
     omp_set_num_threads(thread_num);
+    TimingStart(&tm);
 
 #pragma omp parallel
     {
         int id = omp_get_thread_num();
-        themin[id] = min;
-        double temp;
-        double x1, x2;
-#pragma omp for
+        gridmin *mine = (gridmin *) Slot(&mins, id);
+        unsigned long long my_rows = 0;
+        argval row;
+        double x1;
+
+        // nowait: the wait at the barrier is not busy time
+        TimingBegin(&tm, id);
+#pragma omp for nowait
         for (int i = 0; i < 15000; i++) {
             x1 = x1_low + (double)i * step;
-            for(x2= x2_low; x2<= x2_up; x2+=step){
-                temp = a*pow((x2-b*x1*x1 + c*x1 -r),2)+s*(1-t)*cos(x1) +s;
-                if(temp  < themin[id]){
-                    min_1[id] = x1;
-                    min_2[id] = x2;
-                    themin[id] = temp;
-                }
+            row = BraninRow(x1, x2_low, step, n2);   // x2 sweep, see grid.h
+            if(row.val < mine->val){
+                mine->x1 = x1;
+                mine->x2 = x2_low + (double)row.arg * step;
+                mine->val = row.val;
             }
+            my_rows++;
         }
+        TimingEnd(&tm, id, my_rows * n2);
     }
-
-    end = clock();
+    TimingStop(&tm);
     cout.precision(5);
     
-    min = themin[0];
-    min_x1 = min_1[0];
-    min_x2 = min_2[0];
-    for (int i = 1; i < thread_num; i++)
-        if (min > themin[i]) {
-            min = themin[i];
-            min_x1 = min_1[i];
-            min_x2 = min_2[i];
-        }
+    best = *(gridmin *) Slot(&mins, 0);
+    SlotsMerge(&mins, &best, GridMinMerge);
+    SlotsRelease(&mins);
 
 
-    cout << "max fit =  fit(" << min_x1 << ","<< min_x2<<") = " << min << endl;
-    cout << "time = " << double(end-start)/CLOCKS_PER_SEC/thread_num << " sec"<< endl;
+    cout << "max fit =  fit(" << best.x1 << ","<< best.x2<<") = " << best.val << endl;
+    cout << "time = " << tm.wall << " sec"<< endl;
+    TimingReport(&tm, stdout);
+    TimingRelease(&tm);
 
     return 0;
 }
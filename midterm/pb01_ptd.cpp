@@ -2,7 +2,9 @@
 #include <stdlib.h>
 #include <pthread.h>
 #include <math.h>
-#include <time.h>
+#include "slots.h"
+#include "timing.h"
+#include "grid.h"
 using namespace std;
 #define pi  3.141592653589793
 double a=1;
@@ -19,60 +21,105 @@ double x2_up = 15;
 double step = 1E-3;
 
 int thread_num = 1;
-double *themin;
-double *min_x1;
-double *min_x2;
+
+// The 15000 x1 rows are handed out in chunks through an atomic counter,
+// so every row is scanned once and a thread that is slowed down simply
+// takes fewer chunks.  With chunk 0 the scheduling is guided: a chunk is
+// the rows still left over 2*thread_num, shrinking towards the end.
+int rows = 15000;
+int chunk = 0;
+int next_row = 0;
+
+// minimum found by one thread, kept in its own slot (slots.h)
+typedef struct tag_gridmin{
+    double val, x1, x2;
+}gridmin;
+
+slots mins;
+timing tm;
 
 double fit(double x1,double x2) {
     return a*pow((x2-b*x1*x1 + c*x1 -r),2)+s*(1-t)*cos(x1) +s;
 }
 
+// on equal values the smaller x1 wins, whichever thread scanned it
+void GridMinMerge(void *best, const void *other) {
+    gridmin *b = (gridmin *) best;
+    const gridmin *o = (const gridmin *) other;
+    if (o->val < b->val || (o->val == b->val && o->x1 < b->x1))
+        *b = *o;
+}
+
+// claims the next chunk of rows, returns its first row or -1 when done
+int NextChunk(int *cnt) {
+    int first = __atomic_load_n(&next_row, __ATOMIC_RELAXED), n;
+    do {
+        if (first >= rows)
+            return -1;
+        n = chunk ? chunk : (rows - first) / (2 * thread_num);
+        if (n < 1) n = 1;
+        if (n > rows - first) n = rows - first;
+    } while (!__atomic_compare_exchange_n(&next_row, &first, first + n, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    *cnt = n;
+    return first;
+}
+
 void *threadCalcu(void *rank) {
     long threadId = (long) rank;
-    double dist = 15000/thread_num;
-    double my_first_x1 = threadId * dist;
-    double my_last_x1 = my_first_x1 + dist;
-    double temp;
-    double x1, x2;
-
-    for(int i = my_first_x1; i < my_last_x1; i++){
-        x1 = x1_low + (double) i * step;
-        for(x2= x2_low; x2<= x2_up; x2+=step){
-            temp = fit(x1, x2);
-            if(temp < themin[threadId]){
-                min_x1[threadId] = x1;
-                min_x2[threadId] = x2;
-                themin[threadId] = temp;
+    gridmin *mine = (gridmin *) Slot(&mins, threadId);
+    unsigned long long n2 = GridPoints(x2_low, x2_up, step);
+    unsigned long long my_rows = 0;
+    argval row;
+    double x1;
+    int first, cnt;
+
+    TimingBegin(&tm, threadId);
+    // chunks come in increasing order, so '<' keeps the smallest x1
+    while((first = NextChunk(&cnt)) >= 0) {
+        for(int i = first; i < first + cnt; i++){
+            x1 = x1_low + (double) i * step;
+            row = BraninRow(x1, x2_low, step, n2);   // x2 sweep, see grid.h
+            if(row.val < mine->val){
+                mine->x1 = x1;
+                mine->x2 = x2_low + (double)row.arg * step;
+                mine->val = row.val;
             }
         }
+        my_rows += cnt;
     }
+    TimingEnd(&tm, threadId, my_rows * n2);
     return NULL;
 }
 
 int main(int argc, char *argv[]){
 
-    if (argc !=2) {
-        cout << "Usage: pb01_ptd [num]" << endl;
+    if (argc < 2 || argc > 3) {
+        cout << "Usage: pb01_ptd [num] [chunk]  (chunk 0: guided, default)" << endl;
         exit(1);
     }
 
     thread_num = atoi(argv[1]);
+    if (argc > 2) chunk = atoi(argv[2]);
+    if (thread_num <= 0 || chunk < 0) {
+        cout << "thread number must be positive, chunk not negative" << endl;
+        exit(1);
+    }
 
     pthread_t * thread_p;
     thread_p = (pthread_t *) malloc(thread_num * sizeof(pthread_t));
-    themin = (double *) malloc(thread_num * sizeof(double));
-    min_x1 = (double *) malloc(thread_num * sizeof(double));
-    min_x2 = (double *) malloc(thread_num * sizeof(double));
+    SlotsInit(&mins, thread_num, sizeof(gridmin));
     double temp = fit(x1_low, x2_low);
     for (int i = 0; i < thread_num; i++) {
-        themin[i] = temp;
-        min_x1[i] = x1_low;
-        min_x2[i] = x2_low;
+        gridmin *m = (gridmin *) Slot(&mins, i);
+        m->val = temp;
+        m->x1 = x1_low;
+        m->x2 = x2_low;
     }
         
 
-    clock_t start,end;
-    start = clock();
+    TimingInit(&tm, "pb01_ptd", thread_num);
+    TimingStart(&tm);
 
     for (long i = 0; i < thread_num; i++)
         pthread_create(&thread_p[i], NULL, threadCalcu, (void *)i);
@@ -80,21 +127,17 @@ int main(int argc, char *argv[]){
     for (int i = 0; i < thread_num; i++)
         pthread_join(thread_p[i], NULL);
 
-    end = clock();
+    TimingStop(&tm);
     cout.precision(5);
 
-    double min = themin[0];
-    double min1 = min_x1[0];
-    double min2 = min_x2[0];
-    for (int i = 1; i < thread_num; i++)
-        if (min > themin[i]) {
-            min = themin[i];
-            min1 = min_x1[i];
-            min2 = min_x2[i];
-        }
+    gridmin best = *(gridmin *) Slot(&mins, 0);
+    SlotsMerge(&mins, &best, GridMinMerge);
+    SlotsRelease(&mins);
 
-    cout << "max fit =  fit(" << min1 << ","<< min2<<") = " << min << endl;
-    cout << "time = " << double(end-start)/CLOCKS_PER_SEC/thread_num << " sec"<< endl;
+    cout << "max fit =  fit(" << best.x1 << ","<< best.x2<<") = " << best.val << endl;
+    cout << "time = " << tm.wall << " sec"<< endl;
+    TimingReport(&tm, stdout);
+    TimingRelease(&tm);
 
     return 0;
 }
@@ -0,0 +1,313 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "pso.h"
+#include "monitor.h"
+#include "slots.h"
+#include "timing.h"
+
+// -----------------------------------------------------------------------
+// * Asynchronous PSO for expensive objectives.  The swarm is split into *
+// * batches of a few particles (SwarmBatches) which circulate through a *
+// * task queue.  A fitness worker takes a batch, moves it towards a     *
+// * snapshot of the current gbest, evaluates it, merges its best into   *
+// * gbest and puts it back at the end of the queue.  No worker ever     *
+// * waits for the rest of the generation, so the cores stay busy when   *
+// * the evaluation times vary.                                          *
+// *                                                                     *
+// * The synchronous version runs the same batches generation by         *
+// * generation: the workers take the batches of a generation from a     *
+// * shared counter, meet at a barrier, and the serial thread of the     *
+// * barrier merges their lbest slots into gbest.  Every worker waits    *
+// * for the slowest batch of each generation.                           *
+// *                                                                     *
+// * The cost of an evaluation is simulated by a busy wait of -c         *
+// * microseconds times a factor between 1 and -v, which depends on the  *
+// * position of the particle.                                           *
+// *                                                                     *
+// * The diameter criterion (-d) works only with -m sync: the async      *
+// * workers move their batches while gbest is checked, so there is no   *
+// * point at which the whole swarm could be measured.                   *
+// -----------------------------------------------------------------------
+
+enum { ASYNC = 1, SYNC = 2 };
+
+typedef struct tag_costly{
+    const objective *inner;
+    double cost;                        /* seconds per evaluation     */
+    double spread;                      /* slowest / fastest          */
+}costly;
+
+typedef struct tag_taskq{
+    unsigned *buf, cap;                 /* batch indices, FIFO        */
+    unsigned head, tail;
+    int closed;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+}taskq;
+
+int thread_num = 4;
+unsigned particle_cnt = 64, batch_size = 4, dim = 10;
+const char *name = "rastrigin";
+pso_stop crit;
+
+swarm *s;
+pso_batch *batches;
+unsigned batch_cnt;
+pso_monitor mon;
+int stop;
+
+// the inner objective followed by a busy wait for each particle
+void CostlyEval(const double *x, unsigned stride, unsigned dim,
+                unsigned cnt, double *f, void *data)
+{
+    const costly *c = (const costly*)data;
+    unsigned long long h;
+    unsigned i;
+    double until;
+
+    c->inner->eval(x, stride, dim, cnt, f, c->inner->data);
+    for (i = 0; i < cnt; i++) {
+        memcpy(&h, &x[i], sizeof h);
+        h *= 0x9e3779b97f4a7c15ull;
+        until = WallTime() + c->cost * (1.0 + (c->spread - 1.0) * (h >> 11) * 0x1p-53);
+        while (WallTime() < until)
+            ;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void QueueInit(taskq *q, unsigned cap)
+{
+    q->buf = (unsigned*)malloc(cap * sizeof(unsigned));
+    q->cap = cap;
+    q->head = q->tail = 0;
+    q->closed = 0;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->ready, NULL);
+}
+
+void QueueRelease(taskq *q)
+{
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->ready);
+    free(q->buf);
+}
+
+void QueuePush(taskq *q, unsigned k)
+{
+    pthread_mutex_lock(&q->lock);
+    q->buf[q->tail++ % q->cap] = k;
+    pthread_cond_signal(&q->ready);
+    pthread_mutex_unlock(&q->lock);
+}
+
+// wakes up all waiting workers, QueuePop fails from now on
+void QueueClose(taskq *q)
+{
+    pthread_mutex_lock(&q->lock);
+    q->closed = 1;
+    pthread_cond_broadcast(&q->ready);
+    pthread_mutex_unlock(&q->lock);
+}
+
+int QueuePop(taskq *q, unsigned *k)
+{
+    int ok;
+    pthread_mutex_lock(&q->lock);
+    while (!q->closed && q->head == q->tail)
+        pthread_cond_wait(&q->ready, &q->lock);
+    ok = !q->closed;
+    if (ok)
+        *k = q->buf[q->head++ % q->cap];
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+taskq queue;
+pthread_mutex_t gbest_lock = PTHREAD_MUTEX_INITIALIZER;
+unsigned long long moved;               /* particles moved so far     */
+unsigned long long generation;          /* moved / particle_cnt       */
+
+void *threadAsync(void *rank) {
+    double *gpos = (double*)malloc(dim * sizeof(double));
+    unsigned long long iter;
+    pso_best best;
+    unsigned k;
+
+    while (QueuePop(&queue, &k)) {
+        pthread_mutex_lock(&gbest_lock);
+        memcpy(gpos, s->gbest_pos, s->dim * sizeof(double));
+        iter = generation;
+        pthread_mutex_unlock(&gbest_lock);
+
+        BestReset(&best);
+        SwarmMoveBatch(s, &batches[k], gpos, iter, &best);
+
+        pthread_mutex_lock(&gbest_lock);
+        SwarmUpdateBest(s, &best);
+        moved += batches[k].cnt;
+        if (!stop && moved / particle_cnt > generation) {
+            generation = moved / particle_cnt;
+            stop = MonitorCheck(&mon, s, generation);
+        }
+        pthread_mutex_unlock(&gbest_lock);
+
+        if (stop)
+            QueueClose(&queue);
+        else
+            QueuePush(&queue, k);
+    }
+    free(gpos);
+    return NULL;
+}
+
+slots lbest;
+unsigned next_batch;                    /* taken from by all workers  */
+pthread_barrier_t barrier;
+
+void *threadSync(void *rank) {
+    long id = (long) rank;
+    pso_best best, *mine = Slot(&lbest, id);
+    unsigned long long iter;
+    unsigned k;
+    int i;
+
+    for (iter = 0; !stop; iter++) {
+        BestReset(mine);
+        while ((k = __atomic_fetch_add(&next_batch, 1, __ATOMIC_RELAXED)) < batch_cnt)
+            SwarmMoveBatch(s, &batches[k], s->gbest_pos, iter, mine);
+        if (pthread_barrier_wait(&barrier) == PTHREAD_BARRIER_SERIAL_THREAD) {
+            BestReset(&best);
+            for (i = 0; i < thread_num; i++)
+                BestMerge(&best, Slot(&lbest, i));
+            SwarmUpdateBest(s, &best);
+            next_batch = 0;
+            stop = MonitorCheck(&mon, s, iter + 1);
+        }
+        pthread_barrier_wait(&barrier);
+    }
+    return NULL;
+}
+
+void Run(int mode, const objective *obj)
+{
+    pthread_t *thread_p = (pthread_t *)malloc(thread_num * sizeof(pthread_t));
+    long i;
+
+    s = SwarmAllocate(obj, particle_cnt);
+    SwarmInit(s, 0);
+    batches = SwarmBatches(s, batch_size, 1, &batch_cnt);
+    MonitorInit(&mon, &crit, 0, s);
+    stop = 0;
+
+    if (mode == ASYNC) {
+        moved = generation = 0;
+        QueueInit(&queue, batch_cnt);
+        for (i = 0; i < batch_cnt; i++)
+            QueuePush(&queue, i);
+        for (i = 0; i < thread_num; i++)
+            pthread_create(&thread_p[i], NULL, threadAsync, (void*)i);
+    }
+    else {
+        next_batch = 0;
+        SlotsInit(&lbest, thread_num, sizeof(pso_best));
+        pthread_barrier_init(&barrier, NULL, thread_num);
+        for (i = 0; i < thread_num; i++)
+            pthread_create(&thread_p[i], NULL, threadSync, (void*)i);
+    }
+    for (i = 0; i < thread_num; i++)
+        pthread_join(thread_p[i], NULL);
+
+    printf("%-5s: %8.3lf sec, %llu generations (%s), %8.0lf evaluations/sec, best %.10g\n",
+           mode == ASYNC ? "async" : "sync", mon.trace[mon.trace_cnt-1].wall,
+           mon.iter, pso_reason[mon.reason],
+           (double)mon.iter * particle_cnt / mon.trace[mon.trace_cnt-1].wall,
+           SwarmBestValue(s));
+
+    if (mode == ASYNC)
+        QueueRelease(&queue);
+    else {
+        pthread_barrier_destroy(&barrier);
+        SlotsRelease(&lbest);
+    }
+    MonitorRelease(&mon);
+    BatchesRelease(batches, batch_cnt);
+    SwarmRelease(s);
+    free(thread_p);
+}
+
+void Usage()
+{
+    printf("Usage: pb02_async [options]\n"
+           "  -n <threads>    number of fitness workers (default 4)\n"
+           "  -o <objective>  built-in objective (default rastrigin)\n"
+           "  -D <dim>        dimensions (default 10)\n"
+           "  -P <particles>  particles (default 64)\n"
+           "  -k <size>       particles per batch (default 4)\n"
+           "  -c <us>         evaluation cost in microseconds (default 100)\n"
+           "  -v <factor>     slowest / fastest evaluation (default 10)\n"
+           "  -m async|sync|both  version to run (default both, -d: sync)\n"
+           PSO_STOP_USAGE);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    int opt, mode = ASYNC | SYNC;
+    objective *inner, obj;
+    costly c;
+
+    StopDefault(&crit, 100);
+    c.cost = 100e-6;
+    c.spread = 10.0;
+    while ((opt = getopt(argc, argv, PSO_STOP_OPTIONS "n:o:D:P:k:c:v:m:")) != -1) {
+        if (StopOption(&crit, opt, optarg)) continue;
+        switch (opt) {
+            case 'n': thread_num = atoi(optarg); break;
+            case 'o': name = optarg; break;
+            case 'D': dim = atoi(optarg); break;
+            case 'P': particle_cnt = atoi(optarg); break;
+            case 'k': batch_size = atoi(optarg); break;
+            case 'c': c.cost = atof(optarg) * 1e-6; break;
+            case 'v': c.spread = atof(optarg); break;
+            case 'm':
+                if (!strcmp(optarg, "async")) mode = ASYNC;
+                else if (!strcmp(optarg, "sync")) mode = SYNC;
+                else if (!strcmp(optarg, "both")) mode = ASYNC | SYNC;
+                else Usage();
+                break;
+            default: Usage();
+        }
+    }
+    if (optind != argc || thread_num <= 0 || !particle_cnt || !batch_size ||
+        c.spread < 1.0)
+        Usage();
+    if (crit.diameter > 0 && (mode & ASYNC)) {
+        printf("-d needs -m sync, the async swarm is never at rest\n");
+        exit(1);
+    }
+    if (!(inner = ObjectiveCreate(name, dim)) || inner->dim > PSO_MAX_DIM)
+        Usage();
+    dim = inner->dim;
+
+    // the built-in objective with the simulated cost
+    obj = *inner;
+    obj.eval = CostlyEval;
+    obj.data = &c;
+    c.inner = inner;
+
+    PsoSetParam(0.729, 1.49445, 1.49445, 0.2);
+    printf("%s, %u dimensions, %u particles in batches of %u, %d workers, "
+           "%.0lf-%.0lf us per evaluation\n", obj.name, dim, particle_cnt,
+           batch_size, thread_num, c.cost * 1e6, c.cost * c.spread * 1e6);
+    if (mode & ASYNC) Run(ASYNC, &obj);
+    if (mode & SYNC) Run(SYNC, &obj);
+    ObjectiveRelease(inner);
+    return 0;
+}
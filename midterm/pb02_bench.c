@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "pso.h"
+#include "timing.h"
+
+// -----------------------------------------------------------------------
+// * Single thread throughput of the PSO update: the array-of-structs    *
+// * ParticleMove of pb02_omp.c with rand() against the structure-of-    *
+// * arrays SwarmMove of pso.c.  Usage: ./pb02_bench [iters] [particles] *
+// -----------------------------------------------------------------------
+
+typedef struct tag_particle{
+    double position;
+    double velocity;
+    double fitness ;
+    double pbest_pos;
+    double pbest_fit;
+}particle;
+
+double w = 1.00, c1 = 2.0, c2 = 2.0;
+double max_pos = +100.0, min_pos = -100.0;
+double max_v = 200.0;
+unsigned particle_cnt = 200;
+particle gbest;
+
+#define RND() ((double)rand()/RAND_MAX)
+
+// x**3 - 0.8x**2 - 10000x + 8000, the "cubic" objective
+double fit(double x)
+{
+    return fabs(8000.0 + x*(-10000.0+x*(-0.8+x)));
+}
+
+void ParticleInit(particle *p)
+{
+    unsigned i;
+    const double pos_range = max_pos - min_pos;
+    srand(0);
+    for(i=0; i<particle_cnt; i++) {
+        p[i].pbest_pos = p[i].position = RND() * pos_range + min_pos;
+        p[i].velocity = RND() * max_v;
+        p[i].pbest_fit = p[i].fitness = fit(p[i].position);
+        if(i==0 || p[i].pbest_fit > gbest.fitness)
+            memcpy((void*)&gbest, (void*)&p[i], sizeof(particle));
+    }
+}
+
+// the update of pb02_omp.c without the critical section
+void ParticleMove(particle *p)
+{
+    unsigned i;
+    double v, pos;
+    double ppos, gpos;
+    gpos = gbest.position;
+
+    for(i=0; i<particle_cnt; i++){
+        v = p[i].velocity;
+        pos=p[i].position;
+        ppos=p[i].pbest_pos;
+
+        v = w*v + c1*RND()*(ppos-pos) + c2*RND()*(gpos-pos);
+        if(v<-max_v) v=-max_v;
+        else if(v>max_v) v=max_v;
+
+        pos = pos + v;
+        if(pos>max_pos) pos=max_pos;
+        else if(pos<min_pos) pos=min_pos;
+
+        p[i].velocity= v;
+        p[i].position=pos;
+        p[i].fitness = fit(pos);
+
+        if(p[i].fitness > p[i].pbest_fit) {
+            p[i].pbest_fit = p[i].fitness ;
+            p[i].pbest_pos = p[i].position;
+        }
+        if(p[i].fitness > gbest.fitness)
+            memcpy((void*)&gbest, (void*)&p[i], sizeof(particle));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned j, max_itera = 1000000;
+    double start, aos, soa, updates;
+    particle *p;
+    objective *obj;
+    swarm *s;
+
+    if (argc > 1) max_itera = atoi(argv[1]);
+    if (argc > 2) particle_cnt = atoi(argv[2]);
+    if (argc > 3 || !max_itera || !particle_cnt) {
+        printf("Usage: ./pb02_bench [iterations] [particles]\n");
+        exit(1);
+    }
+    updates = (double)max_itera * particle_cnt;
+
+    p = (particle*)malloc(sizeof(particle)*particle_cnt);
+    ParticleInit(p);
+    start = WallTime();
+    for(j=0; j<max_itera; j++)
+        ParticleMove(p);
+    aos = WallTime() - start;
+    free(p);
+
+    PsoSetParam(w, c1, c2, max_v / (max_pos - min_pos));
+    obj = ObjectiveCreate("cubic", 1);
+    s = SwarmAllocate(obj, particle_cnt);
+    SwarmInit(s, 0);
+    start = WallTime();
+    for(j=0; j<max_itera; j++)
+        SwarmMove(s);
+    soa = WallTime() - start;
+
+    printf("%u particles, %u iterations\n", particle_cnt, max_itera);
+    printf("AoS ParticleMove : %8.3lf sec %8.2lf M updates/sec  solution %10.6lf , %lf\n",
+           aos, updates / aos / 1e6, gbest.position, gbest.fitness);
+    printf("SoA SwarmMove    : %8.3lf sec %8.2lf M updates/sec  solution %10.6lf , %lf\n",
+           soa, updates / soa / 1e6, s->gbest_pos[0], s->gbest_fit);
+    printf("speedup          : %8.2lf\n", aos / soa);
+    SwarmRelease(s);
+    ObjectiveRelease(obj);
+    return 0;
+}
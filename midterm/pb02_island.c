@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "pso.h"
+#include "rng.h"
+#include "spsc.h"
+#include "slots.h"
+#include "timing.h"
+
+// -----------------------------------------------------------------------
+// * Island model PSO.  Every thread owns its own swarm (island) and     *
+// * runs it without any synchronization.  Every 'interval' iterations   *
+// * an island sends copies of its best particles to one neighbour and   *
+// * takes in the migrants waiting for it, which replace its worst       *
+// * particles.  Each pair of islands has its own lock-free single-      *
+// * producer/single-consumer queue, so migration never blocks: a full   *
+// * queue drops the migrant.  The neighbour is the next island in a     *
+// * ring or a random other island.  All islands stop as soon as one of  *
+// * them reaches the target fitness.                                    *
+// *                                                                     *
+// * With -c the data parallel PSO of pb02_ptd.c over one swarm of the   *
+// * same total size on the same number of threads is run as well, to    *
+// * compare the time to reach the target.                               *
+// -----------------------------------------------------------------------
+
+enum { RING, RANDOM };
+
+typedef struct tag_island{
+    swarm *s;
+    unsigned long long itera;            /* iterations done          */
+    unsigned long long rng;              /* picks random neighbours  */
+    unsigned sent, received, dropped;    /* migration statistics     */
+}island;
+
+int islands = 4;                         /* number of islands/threads */
+unsigned particle_cnt = 50;              /* particles per island      */
+unsigned interval = 100;                 /* migration interval        */
+unsigned emigrants = 1;                  /* migrants per migration    */
+int topology = RING;
+unsigned long long max_itera = 1000000;  /* iterations per island     */
+unsigned long long seed = 0;
+double target = 390245.7917;             /* target fitness            */
+
+objective *obj;                          /* the pb02 cubic            */
+slots isle;                              /* island of each thread     */
+spsc *queues;                            /* queues[src*islands + dst] */
+int reached;                             /* target fitness reached    */
+double start, reached_time;
+
+// first to reach the target records the time, the others only stop
+void Reached()
+{
+    int expected = 0;
+    double now = WallTime() - start;
+    if (__atomic_compare_exchange_n(&reached, &expected, 1, 0,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        reached_time = now;
+}
+
+int Neighbour(island *me, int id)
+{
+    int other;
+    if (topology == RING)
+        return (id + 1) % islands;
+    me->rng ^= me->rng >> 12;
+    me->rng ^= me->rng << 25;
+    me->rng ^= me->rng >> 27;
+    other = (me->rng * 2685821657736338717ull >> 33) % (islands - 1);
+    return other < id ? other : other + 1;
+}
+
+void Migrate(island *me, int id, pso_best *out)
+{
+    int dst = Neighbour(me, id), src;
+    unsigned i, k = SwarmEmigrants(me->s, out, emigrants);
+    pso_best m;
+
+    for (i = 0; i < k; i++) {
+        if (SpscPush(&queues[id * islands + dst], &out[i])) me->sent++;
+        else me->dropped++;
+    }
+    for (src = 0; src < islands; src++)
+        while (SpscPop(&queues[src * islands + id], &m))
+            me->received += SwarmImmigrate(me->s, &m);
+}
+
+// the island is worked on in a local copy, published to its slot when
+// it stops
+void *threadIsland(void *rank) {
+    long id = (long) rank;
+    island my = *(island*)Slot(&isle, id), *me = &my;
+    pso_best *out = (pso_best*)malloc(sizeof(pso_best) * emigrants);
+
+    while (me->itera < max_itera && !__atomic_load_n(&reached, __ATOMIC_ACQUIRE)) {
+        SwarmMove(me->s);
+        me->itera++;
+        if (me->s->gbest_fit >= target) {
+            Reached();
+            break;
+        }
+        if (islands > 1 && me->itera % interval == 0)
+            Migrate(me, id, out);
+    }
+    *(island*)Slot(&isle, id) = my;
+    free(out);
+    return NULL;
+}
+
+// -----------------------------------------------------------------------
+// * The data parallel version of pb02_ptd.c (K = 1) for comparison.     *
+// -----------------------------------------------------------------------
+
+swarm *whole;
+slots lbest;
+pthread_barrier_t barrier;
+unsigned long long whole_itera;
+
+void *threadChunks(void *rank) {
+    long id = (long) rank;
+    unsigned chunks = SwarmChunks(whole);
+    unsigned first = id * chunks / islands;
+    unsigned last = (id + 1) * chunks / islands;
+    unsigned long long k;
+    pso_best best, *mine = Slot(&lbest, id);
+    int i;
+
+    for (k = 0; k < max_itera && !reached; k++) {
+        BestReset(mine);
+        SwarmMoveChunks(whole, first, last, k, mine);
+        if (pthread_barrier_wait(&barrier) == PTHREAD_BARRIER_SERIAL_THREAD) {
+            BestReset(&best);
+            for (i = 0; i < islands; i++)
+                BestMerge(&best, Slot(&lbest, i));
+            SwarmUpdateBest(whole, &best);
+            whole_itera = k + 1;
+            if (whole->gbest_fit >= target)
+                Reached();
+        }
+        pthread_barrier_wait(&barrier);
+    }
+    return NULL;
+}
+
+void Usage()
+{
+    printf("Usage: pb02_island [options]\n"
+           "  -n <islands>    number of islands and threads (default 4)\n"
+           "  -p <particles>  particles per island (default 50)\n"
+           "  -m <interval>   iterations between migrations (default 100)\n"
+           "  -e <emigrants>  best particles sent per migration (default 1)\n"
+           "  -t ring|random  migration topology (default ring)\n"
+           "  -i <iterations> maximum iterations (default 1000000)\n"
+           "  -f <fitness>    target fitness (default %.4lf)\n"
+           "  -s <seed>       random seed (default 0)\n"
+           "  -c              also run the data parallel version\n", target);
+    exit(1);
+}
+
+void Report(const char *name, unsigned long long itera, double gpos, double gfit)
+{
+    printf("%-8s: %s after %10.6lf sec, %llu iterations, solution %10.6lf , %lf\n",
+           name, reached ? "target reached" : "target missed ",
+           reached ? reached_time : WallTime() - start, itera, gpos, gfit);
+}
+
+int main(int argc, char *argv[])
+{
+    pthread_t *thread_p;
+    unsigned sent = 0, received = 0, dropped = 0;
+    unsigned long long itera = 0;
+    pso_best best, b;
+    rng streams;
+    int opt, compare = 0;
+    long i;
+
+    while ((opt = getopt(argc, argv, "n:p:m:e:t:i:f:s:c")) != -1) {
+        switch (opt) {
+            case 'n': islands = atoi(optarg); break;
+            case 'p': particle_cnt = atoi(optarg); break;
+            case 'm': interval = atoi(optarg); break;
+            case 'e': emigrants = atoi(optarg); break;
+            case 't':
+                if (!strcmp(optarg, "ring")) topology = RING;
+                else if (!strcmp(optarg, "random")) topology = RANDOM;
+                else Usage();
+                break;
+            case 'i': max_itera = strtoull(optarg, 0, 10); break;
+            case 'f': target = atof(optarg); break;
+            case 's': seed = strtoull(optarg, 0, 10); break;
+            case 'c': compare = 1; break;
+            default: Usage();
+        }
+    }
+    if (optind != argc || islands <= 0 || !particle_cnt || !interval || !emigrants)
+        Usage();
+
+    PsoSetParam(1.0, 2.0, 2.0, 1.0);
+    obj = ObjectiveCreate("cubic", 1);
+    thread_p = (pthread_t *)malloc(islands * sizeof(pthread_t));
+
+    /* island model */
+    SlotsInit(&isle, islands, sizeof(island));
+    queues = (spsc*)calloc((size_t)islands * islands, sizeof(spsc));
+    RngSeed(&streams, seed);            // island i: the streams after i-1
+    for (i = 0; i < islands; i++) {
+        island *me = (island*)Slot(&isle, i);
+        me->s = SwarmAllocate(obj, particle_cnt);
+        SwarmInitStreams(me->s, &streams);
+        me->rng = seed + i + 1;
+    }
+    for (i = 0; i < islands * islands; i++)
+        SpscInit(&queues[i], 4 * emigrants, sizeof(pso_best));
+
+    start = WallTime();
+    for (i = 0; i < islands; i++)
+        pthread_create(&thread_p[i], NULL, threadIsland, (void*)i);
+    for (i = 0; i < islands; i++)
+        pthread_join(thread_p[i], NULL);
+
+    BestReset(&best);
+    for (i = 0; i < islands; i++) {
+        const island *me = (const island*)Slot(&isle, i);
+        b.fit = me->s->gbest_fit;
+        b.order = i;
+        b.dim = 1;
+        b.pos[0] = me->s->gbest_pos[0];
+        BestMerge(&best, &b);
+        if (me->itera > itera) itera = me->itera;
+        sent += me->sent;
+        received += me->received;
+        dropped += me->dropped;
+    }
+    printf("%d islands of %u particles, %s topology, migration every %u iterations\n",
+           islands, particle_cnt, topology == RING ? "ring" : "random", interval);
+    Report("island", itera, best.pos[0], best.fit);
+    printf("migrants: %u sent, %u accepted, %u dropped\n", sent, received, dropped);
+
+    for (i = 0; i < islands; i++)
+        SwarmRelease(((island*)Slot(&isle, i))->s);
+    for (i = 0; i < islands * islands; i++)
+        SpscRelease(&queues[i]);
+    SlotsRelease(&isle);
+    free(queues);
+
+    /* data parallel version */
+    if (compare) {
+        reached = 0;
+        whole = SwarmAllocate(obj, islands * particle_cnt);
+        SwarmInit(whole, seed);
+        SlotsInit(&lbest, islands, sizeof(pso_best));
+        pthread_barrier_init(&barrier, NULL, islands);
+        start = WallTime();
+        for (i = 0; i < islands; i++)
+            pthread_create(&thread_p[i], NULL, threadChunks, (void*)i);
+        for (i = 0; i < islands; i++)
+            pthread_join(thread_p[i], NULL);
+        Report("parallel", whole_itera, whole->gbest_pos[0], whole->gbest_fit);
+        pthread_barrier_destroy(&barrier);
+        SwarmRelease(whole);
+        SlotsRelease(&lbest);
+    }
+
+    free(thread_p);
+    ObjectiveRelease(obj);
+    return 0;
+}
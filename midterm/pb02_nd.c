@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <omp.h>
+#include "pso.h"
+#include "monitor.h"
+#include "slots.h"
+
+// -----------------------------------------------------------------------
+// * PSO on a built-in objective of objective.h in any number of         *
+// * dimensions, data parallel with OpenMP as in pb02_omp.c (K = 1),     *
+// * until one of the stopping criteria of monitor.h is met.             *
+// -----------------------------------------------------------------------
+
+void Usage()
+{
+    printf("Usage: ./pb02_nd [options] <cubic|branin|rastrigin|rosenbrock>"
+           " [dim] [particles] [threads]\n"
+           PSO_STOP_USAGE
+           "  -p <iterations> telemetry sample period\n"
+           "  -T <file>       write the telemetry to file, - for stdout\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned dim = 10, particle_cnt = 200, chunks, d;
+    unsigned long long period = 0;
+    const char *trace = NULL;
+    int num = 1, opt, stop = 0;
+    double sec;
+    pso_best best;
+    slots lbest;
+    pso_stop crit;
+    pso_monitor mon;
+    objective *obj;
+    swarm *s;
+
+    StopDefault(&crit, 10000);
+    while ((opt = getopt(argc, argv, PSO_STOP_OPTIONS "p:T:")) != -1) {
+        if (StopOption(&crit, opt, optarg)) continue;
+        else if (opt == 'p') period = strtoull(optarg, 0, 10);
+        else if (opt == 'T') trace = optarg;
+        else Usage();
+    }
+    argc -= optind, argv += optind;
+    if (argc < 1 || argc > 4) Usage();
+    if (argc > 1) dim = atoi(argv[1]);
+    if (argc > 2) particle_cnt = atoi(argv[2]);
+    if (argc > 3) num = atoi(argv[3]);
+    if (!particle_cnt || num <= 0) Usage();
+    if (!(obj = ObjectiveCreate(argv[0], dim))) Usage();
+    if (!(s = SwarmAllocate(obj, particle_cnt))) {
+        printf("at most %d dimensions\n", PSO_MAX_DIM);
+        exit(1);
+    }
+
+    PsoSetParam(0.729, 1.49445, 1.49445, 0.2);
+    SwarmInit(s, 0);
+    chunks = SwarmChunks(s);
+    SlotsInit(&lbest, num, sizeof(pso_best));
+
+    MonitorInit(&mon, &crit, period, s);
+#pragma omp parallel num_threads(num)
+    {
+        pso_best *mine = Slot(&lbest, omp_get_thread_num());
+        unsigned long long k;
+        unsigned c;
+
+        for(k=0; !stop; k++) {
+            BestReset(mine);
+#pragma omp for schedule(static)
+            for(c=0; c<chunks; c++)
+                SwarmMoveChunks(s, c, c+1, k, mine);
+#pragma omp single
+            {
+                BestReset(&best);
+                for(c=0; c<(unsigned)omp_get_num_threads(); c++)
+                    BestMerge(&best, Slot(&lbest, c));
+                SwarmUpdateBest(s, &best);
+                stop = MonitorCheck(&mon, s, k + 1);
+            }
+        }
+    }
+    sec = mon.trace[mon.trace_cnt-1].wall;
+
+    printf("%s, %u dimensions, %u particles, %d threads\n",
+           obj->name, obj->dim, particle_cnt, num);
+    printf("stopped after %llu iterations (%s)\n", mon.iter, pso_reason[mon.reason]);
+    printf("best value %.10g at (", SwarmBestValue(s));
+    for(d=0; d<obj->dim && d<8; d++)
+        printf("%s%.6lf", d ? ", " : "", s->gbest_pos[d]);
+    printf("%s)\n", obj->dim > 8 ? ", ..." : "");
+    printf("time %.3lf sec, %.2lf M evaluations/sec\n",
+           sec, (double)mon.iter * particle_cnt / sec / 1e6);
+    if (trace) MonitorWrite(&mon, trace);
+    MonitorRelease(&mon);
+
+    SwarmRelease(s);
+    ObjectiveRelease(obj);
+    SlotsRelease(&lbest);
+    return 0;
+}
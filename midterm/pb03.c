@@ -1,7 +1,20 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include <omp.h>
- 
+#include "recur.h"
+
+// -----------------------------------------------------------------------
+// * Without n: the table of fr() and fr_omp() for n < 33.               *
+// * With n: f(n) by the linear scan (n up to SCAN_MAX), by matrix power *
+// * and, for small n, by the task recursion, each timed.  With -p the   *
+// * values are modulo p:  ./pb03 -p 1000000007 1000000000000000000      *
+// -----------------------------------------------------------------------
+
+#define FR_CUTOFF 20                   // fr_omp is serial for n <= 20
+#define SCAN_MAX  1000000000ULL
+#define TASK_MAX  40
+
 int fr(int num)
 {
     if (num==0)
@@ -13,33 +26,79 @@ int fr(int num)
     return (fr(num-1)-2*fr(num-2)+3*fr(num-3)-4);
 }
 
+// one task per call made the task overhead far larger than the work of
+// the call, so only the calls above FR_CUTOFF become tasks (recur.c)
 int fr_omp(int n) {
-    //Write your openMP code here. Do not forget to return value  
-    int i, j, k;
-    if (n <= 2)
-        return n;
-    else {
-#pragma omp task shared(i) firstprivate(n)
-        i = fr_omp(n-1);
-#pragma omp task shared(j) firstprivate(n)
-        j = fr_omp(n-2);
-#pragma omp task shared(k) firstprivate(n)
-        k = fr_omp(n-3);
-
-#pragma omp taskwait
-        return i - 2 * j + 3 * k - 4;
+    int threads = omp_get_max_threads(), f;
+    task_ctl c;
 
-    }
+    TaskCtlInit(&c, TASK_CUTOFF, FR_CUTOFF, threads);
+    f = (int)RecurTasks(n, &c, threads);
+    TaskCtlRelease(&c);
+    return f;
+}
+
+void Usage()
+{
+    printf("Usage: ./pb03 [options] [n]\n"
+           "  -p <modulus>  values modulo p (default 2^64, i.e. 64 bit)\n"
+           "  -n <threads>  threads of the task recursion\n"
+           "  -c <cutoff>   task recursion is serial for n <= cutoff (default %d)\n",
+           FR_CUTOFF);
+    exit(1);
+}
+
+void Print(const char *name, unsigned long long f, unsigned long long p,
+           double sec)
+{
+    if (p)
+        printf("%-8s f(n) mod p = %llu   %.6f sec\n", name, f, sec);
+    else
+        printf("%-8s f(n) = %lld   %.6f sec\n", name, (long long)f, sec);
 }
 
- 
-// And a main program to display the first 20 recursive numbers
-int main(void)
+int main(int argc, char *argv[])
 {
-  int count;
+    unsigned long long n, p = 0, f;
+    int count, opt, threads = omp_get_max_threads(), cutoff = FR_CUTOFF;
+    double start;
+
+    while ((opt = getopt(argc, argv, "p:n:c:")) != -1) {
+        switch (opt) {
+            case 'p': p = strtoull(optarg, NULL, 0); break;
+            case 'n': threads = atoi(optarg); break;
+            case 'c': cutoff = atoi(optarg); break;
+            default: Usage();
+        }
+    }
+    if (argc - optind > 1 || threads <= 0) Usage();
 
-  for (count=0; count < 33; ++count)
-    printf("%d %d %d\n", count, fr(count), fr_omp(count));
- 
-  return 0;
+    // And a main program to display the first 20 recursive numbers
+    if (argc == optind) {
+        for (count=0; count < 33; ++count)
+            printf("%d %d %d\n", count, fr(count), fr_omp(count));
+        return 0;
+    }
+
+    n = strtoull(argv[optind], NULL, 0);
+    printf("n = %llu", n);
+    if (p) printf(", p = %llu", p);
+    printf("\n");
+    if (n <= SCAN_MAX) {
+        start = omp_get_wtime();
+        f = RecurScan(n, p);
+        Print("scan", f, p, omp_get_wtime() - start);
+    }
+    start = omp_get_wtime();
+    f = RecurPower(n, p);
+    Print("power", f, p, omp_get_wtime() - start);
+    if (n <= TASK_MAX && !p) {
+        task_ctl c;
+        TaskCtlInit(&c, TASK_CUTOFF, cutoff, threads);
+        start = omp_get_wtime();
+        f = RecurTasks(n, &c, threads);
+        Print("tasks", f, p, omp_get_wtime() - start);
+        TaskCtlRelease(&c);
+    }
+    return 0;
 }
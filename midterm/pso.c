@@ -0,0 +1,414 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "pso.h"
+#include "rng.h"
+
+// -----------------------------------------------------------------------
+// * Parameters of the swarm, set with PsoSetParam.  The solution space  *
+// * is given by the bounds of the objective, the maximum velocity in    *
+// * dimension d is v_ratio * (hi[d] - lo[d]).                           *
+// -----------------------------------------------------------------------
+
+static double w = 1.0, c1 = 2.0, c2 = 2.0; /* inertia and acceleration */
+static double v_ratio = 1.0;               /* maximum velocity          */
+
+void PsoSetParam(double w_, double c1_, double c2_, double v_ratio_)
+{
+    w = w_, c1 = c1_, c2 = c2_;
+    v_ratio = v_ratio_;
+}
+
+static unsigned padded(unsigned cnt)
+{
+    return (cnt + PSO_CHUNK - 1) / PSO_CHUNK * PSO_CHUNK;
+}
+
+static double* AllocateArray(unsigned cnt)
+{
+    double *a = (double*)aligned_alloc(PSO_ALIGN, padded(cnt) * sizeof(double));
+    memset(a, 0, padded(cnt) * sizeof(double));
+    return a;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+// allocate a swarm of 'cnt' particles for 'obj', NULL if it has too many
+// dimensions
+swarm* SwarmAllocate(const objective *obj, unsigned cnt)
+{
+    swarm *s;
+
+    if(obj->dim == 0 || obj->dim > PSO_MAX_DIM)
+        return NULL;
+    s = (swarm*)calloc(1, sizeof(swarm));
+    s->obj = obj;
+    s->cnt = cnt;
+    s->dim = obj->dim;
+    s->stride = padded(cnt);
+    s->pos = AllocateArray(s->dim * s->stride);
+    s->vel = AllocateArray(s->dim * s->stride);
+    s->fit = AllocateArray(cnt);
+    s->pbest_pos = AllocateArray(s->dim * s->stride);
+    s->pbest_fit = AllocateArray(cnt);
+    s->rnd = AllocateArray(2 * s->dim * s->stride);
+    s->rng = (rng*)aligned_alloc(PSO_ALIGN, SwarmChunks(s) * sizeof(rng));
+    s->gbest_pos = AllocateArray(s->dim);
+    return s;
+}
+
+unsigned SwarmChunks(const swarm *s)
+{
+    return s->stride / PSO_CHUNK;
+}
+
+// the random numbers of chunk 'c' for one step: r1 of dimension d at
+// 2*d*PSO_CHUNK, followed by r2
+static double* ChunkRandom(swarm *s, unsigned c)
+{
+    double *r = s->rnd + 2 * s->dim * c * PSO_CHUNK;
+    RngUniform(&s->rng[c], r, 2 * s->dim * PSO_CHUNK);
+    return r;
+}
+
+static double MaxVelocity(const swarm *s, unsigned d)
+{
+    return v_ratio * (s->obj->hi[d] - s->obj->lo[d]);
+}
+
+// fitness of the 'n' particles starting at 'i'
+static void Evaluate(swarm *s, unsigned i, unsigned n)
+{
+    const objective *obj = s->obj;
+    double *f = s->fit + i;
+    unsigned k;
+
+    obj->eval(s->pos + i, s->stride, s->dim, n, f, obj->data);
+    if(obj->minimize)
+        for(k=0; k<n; k++)
+            f[k] = -f[k];
+}
+
+// random positions and velocities, the same 'seed' gives the same swarm
+void SwarmInit(swarm *s, unsigned long long seed)
+{
+    rng first;
+
+    // chunk c draws from stream c of 'seed'
+    RngSeed(&first, seed);
+    SwarmInitStreams(s, &first);
+}
+
+// as SwarmInit, chunk c draws from the c-th stream from 'next' on, and
+// 'next' is left at the stream after the last chunk; swarms initialized
+// one after another from the same 'next' never share a stream
+void SwarmInitStreams(swarm *s, rng *next)
+{
+    const objective *obj = s->obj;
+    unsigned c, d, i, k, len, g = 0;
+    const double *r;
+
+    s->rng[0] = *next;
+    for(c=1; c<SwarmChunks(s); c++)
+        RngSplit(&s->rng[c], &s->rng[c-1]);
+    RngSplit(next, &s->rng[SwarmChunks(s)-1]);
+    for(c=0; c<SwarmChunks(s); c++) {
+        i = c * PSO_CHUNK;
+        len = s->cnt - i < PSO_CHUNK ? s->cnt - i : PSO_CHUNK;
+        r = ChunkRandom(s, c);
+        for(d=0; d<s->dim; d++) {
+            const double pos_range = obj->hi[d] - obj->lo[d];
+            const double max_v = MaxVelocity(s, d);
+            const size_t o = (size_t)d * s->stride + i;
+            for(k=0; k<len; k++) {
+                s->pbest_pos[o+k] = s->pos[o+k] =
+                    r[2*d*PSO_CHUNK + k] * pos_range + obj->lo[d];
+                s->vel[o+k] = r[(2*d+1)*PSO_CHUNK + k] * max_v;
+            }
+        }
+        Evaluate(s, i, len);
+        for(k=i; k<i+len; k++) {
+            s->pbest_fit[k] = s->fit[k];
+            if(s->fit[k] > s->fit[g])
+                g = k;
+        }
+    }
+    s->gbest_fit = s->fit[g];
+    for(d=0; d<s->dim; d++)
+        s->gbest_pos[d] = s->pos[(size_t)d * s->stride + g];
+}
+
+// -----------------------------------------------------------------------
+// * One synchronous PSO step: all particles are moved towards the gbest *
+// * of the previous step, then gbest is updated once.  A chunk is moved *
+// * one dimension at a time, evaluated as one batch and then its pbests *
+// * are updated.  The clamps and the pbest update are written as        *
+// * selects, so the loops have no branch.  The arrays are 'restrict'    *
+// * parameters, since GCC ignores 'restrict' on local pointers and      *
+// * would give up on the alias checks.                                  *
+// -----------------------------------------------------------------------
+
+static void MoveKernel(unsigned n, double gpos, double max_v,
+                       double min_pos, double max_pos,
+                       double *restrict pos, double *restrict vel,
+                       const double *restrict pbest_pos,
+                       const double *restrict r1, const double *restrict r2)
+{
+    const double w_ = w, c1_ = c1, c2_ = c2;
+    unsigned i;
+
+    for(i=0; i<n; i++) {
+        double v, x;
+        v = w_*vel[i] + c1_*r1[i]*(pbest_pos[i]-pos[i]) + c2_*r2[i]*(gpos-pos[i]);
+        v = v < -max_v ? -max_v : v;         // limit velocity
+        v = v > max_v ? max_v : v;
+        x = pos[i] + v;
+        x = x > max_pos ? max_pos : x;       // limit position
+        x = x < min_pos ? min_pos : x;
+
+        vel[i] = v;
+        pos[i] = x;
+    }
+}
+
+static void PbestKernel(unsigned n, unsigned dim, unsigned stride,
+                        const double *restrict pos,
+                        const double *restrict fitness,
+                        double *restrict pbest_pos, double *restrict pbest_fit)
+{
+    unsigned i, d;
+
+    for(d=0; d<dim; d++) {
+        const double *x = pos + (size_t)d * stride;
+        double *p = pbest_pos + (size_t)d * stride;
+        for(i=0; i<n; i++)
+            p[i] = fitness[i] > pbest_fit[i] ? x[i] : p[i];
+    }
+    for(i=0; i<n; i++)
+        pbest_fit[i] = fitness[i] > pbest_fit[i] ? fitness[i] : pbest_fit[i];
+}
+
+void BestReset(pso_best *best)
+{
+    best->fit = -HUGE_VAL;
+    best->order = ~0ull;
+    best->dim = 0;
+}
+
+// copies only the used part of 'pos'
+static void BestCopy(pso_best *dst, const pso_best *src)
+{
+    dst->fit = src->fit;
+    dst->order = src->order;
+    dst->dim = src->dim;
+    memcpy(dst->pos, src->pos, src->dim * sizeof(double));
+}
+
+// keep the better of both, on equal fitness the one found first
+void BestMerge(pso_best *best, const pso_best *other)
+{
+    if(other->fit > best->fit ||
+       (other->fit == best->fit && other->order < best->order))
+        BestCopy(best, other);
+}
+
+// move the 'n' particles from 'i' towards 'gpos', evaluate them as one
+// batch and update their pbests; r1 of dimension d is r[2*d*m]
+static void MoveRange(swarm *s, unsigned i, unsigned n, const double *gpos,
+                      const double *r, unsigned m)
+{
+    const objective *obj = s->obj;
+    unsigned d;
+    size_t o;
+
+    for(d=0; d<s->dim; d++) {
+        o = (size_t)d * s->stride + i;
+        MoveKernel(n, gpos[d], MaxVelocity(s, d), obj->lo[d], obj->hi[d],
+                   s->pos + o, s->vel + o, s->pbest_pos + o,
+                   r + 2*d*m, r + (2*d+1)*m);
+    }
+    Evaluate(s, i, n);
+    PbestKernel(n, s->dim, s->stride, s->pos + i, s->fit + i,
+                s->pbest_pos + i, s->pbest_fit + i);
+}
+
+// merge the best current particle of lo..hi-1 into 'best'
+static void RangeBest(const swarm *s, unsigned lo, unsigned hi,
+                      unsigned long long iter, pso_best *best)
+{
+    pso_best b;
+    unsigned i, d, k = lo;
+
+    for(i=lo+1; i<hi; i++)
+        if(s->fit[i] > s->fit[k])
+            k = i;
+    b.fit = s->fit[k];
+    b.order = iter * s->cnt + k;
+    b.dim = s->dim;
+    for(d=0; d<s->dim; d++)
+        b.pos[d] = s->pos[(size_t)d * s->stride + k];
+    BestMerge(best, &b);
+}
+
+// -----------------------------------------------------------------------
+// * Move the particles of chunks first..last-1 towards the current      *
+// * gbest and merge the best of them into 'best'.  Different threads    *
+// * may move disjoint chunks at the same time.                          *
+// -----------------------------------------------------------------------
+
+void SwarmMoveChunks(swarm *s, unsigned first, unsigned last,
+                     unsigned long long iter, pso_best *best)
+{
+    const unsigned lo = first * PSO_CHUNK;
+    const unsigned hi = last * PSO_CHUNK < s->cnt ? last * PSO_CHUNK : s->cnt;
+    unsigned c, i, len;
+
+    if(lo >= hi)
+        return;
+    for(c=first; c<last; c++) {
+        i = c * PSO_CHUNK;
+        len = hi - i < PSO_CHUNK ? hi - i : PSO_CHUNK;
+        MoveRange(s, i, len, s->gbest_pos, ChunkRandom(s, c), PSO_CHUNK);
+    }
+    RangeBest(s, lo, hi, iter, best);
+}
+
+// -----------------------------------------------------------------------
+// * Batches for asynchronous PSO: the swarm is split into batches of    *
+// * 'size' particles with their own random streams.  A batch is moved   *
+// * towards a snapshot 'gpos' of gbest taken by the caller, so threads  *
+// * can move different batches while gbest changes.                     *
+// -----------------------------------------------------------------------
+
+// numbers drawn per dimension and r1 or r2 for a batch of 'cnt'
+static unsigned BatchRandom(unsigned cnt)
+{
+    return (cnt + RNG_LANES - 1) / RNG_LANES * RNG_LANES;
+}
+
+pso_batch* SwarmBatches(const swarm *s, unsigned size,
+                        unsigned long long seed, unsigned *cnt)
+{
+    pso_batch *b;
+    unsigned k, n = (s->cnt + size - 1) / size;
+
+    b = (pso_batch*)calloc(n, sizeof(pso_batch));
+    for(k=0; k<n; k++) {
+        b[k].first = k * size;
+        b[k].cnt = s->cnt - b[k].first < size ? s->cnt - b[k].first : size;
+        b[k].rng = (rng*)aligned_alloc(PSO_ALIGN, sizeof(rng));
+        b[k].rnd = AllocateArray(2 * s->dim * BatchRandom(size));
+        if(k == 0)
+            RngSeed(b[k].rng, seed);
+        else
+            RngSplit(b[k].rng, b[k-1].rng);
+    }
+    *cnt = n;
+    return b;
+}
+
+void BatchesRelease(pso_batch *b, unsigned cnt)
+{
+    unsigned k;
+    for(k=0; k<cnt; k++) {
+        free(b[k].rng);
+        free(b[k].rnd);
+    }
+    free(b);
+}
+
+void SwarmMoveBatch(swarm *s, pso_batch *b, const double *gpos,
+                    unsigned long long iter, pso_best *best)
+{
+    const unsigned m = BatchRandom(b->cnt);
+
+    RngUniform(b->rng, b->rnd, 2 * s->dim * m);
+    MoveRange(s, b->first, b->cnt, gpos, b->rnd, m);
+    RangeBest(s, b->first, b->first + b->cnt, iter, best);
+}
+
+// take 'best' as new gbest if it is better
+void SwarmUpdateBest(swarm *s, const pso_best *best)
+{
+    if(best->fit > s->gbest_fit) {
+        s->gbest_fit = best->fit;
+        memcpy(s->gbest_pos, best->pos, s->dim * sizeof(double));
+    }
+}
+
+void SwarmMove(swarm *s)
+{
+    pso_best best;
+    BestReset(&best);
+    SwarmMoveChunks(s, 0, SwarmChunks(s), 0, &best);
+    SwarmUpdateBest(s, &best);
+}
+
+// objective value of gbest
+double SwarmBestValue(const swarm *s)
+{
+    return s->obj->minimize ? -s->gbest_fit : s->gbest_fit;
+}
+
+// -----------------------------------------------------------------------
+// * Island model: the 'cnt' best particles (by pbest) of a swarm leave  *
+// * as copies and replace the worst particle of another swarm, unless   *
+// * they are worse.  'cnt' is small, thus selection is O(n * cnt).      *
+// -----------------------------------------------------------------------
+
+unsigned SwarmEmigrants(const swarm *s, pso_best *out, unsigned cnt)
+{
+    unsigned i, j, d, k = 0;
+
+    if(cnt > s->cnt)
+        cnt = s->cnt;
+    if(!cnt)
+        return 0;
+    for(i=0; i<s->cnt; i++) {
+        if(k == cnt && s->pbest_fit[i] <= out[k-1].fit)
+            continue;
+        j = k < cnt ? k++ : k - 1;  // insertion into out[0..k-1]
+        while(j > 0 && out[j-1].fit < s->pbest_fit[i]) {
+            BestCopy(&out[j], &out[j-1]);
+            j--;
+        }
+        out[j].fit = s->pbest_fit[i];
+        out[j].order = i;
+        out[j].dim = s->dim;
+        for(d=0; d<s->dim; d++)
+            out[j].pos[d] = s->pbest_pos[(size_t)d * s->stride + i];
+    }
+    return k;
+}
+
+// returns 1 if 'migrant' replaced the worst particle
+int SwarmImmigrate(swarm *s, const pso_best *migrant)
+{
+    unsigned i, d, worst = 0;
+
+    for(i=1; i<s->cnt; i++)
+        if(s->pbest_fit[i] < s->pbest_fit[worst])
+            worst = i;
+    if(!(migrant->fit > s->pbest_fit[worst]))
+        return 0;
+    for(d=0; d<s->dim; d++)
+        s->pos[(size_t)d * s->stride + worst] =
+            s->pbest_pos[(size_t)d * s->stride + worst] = migrant->pos[d];
+    s->fit[worst] = s->pbest_fit[worst] = migrant->fit;
+    SwarmUpdateBest(s, migrant);
+    return 1;
+}
+
+// release the swarm
+void SwarmRelease(swarm *s)
+{
+    free(s->pos);
+    free(s->vel);
+    free(s->fit);
+    free(s->pbest_pos);
+    free(s->pbest_fit);
+    free(s->rnd);
+    free(s->rng);
+    free(s->gbest_pos);
+    free(s);
+}
@@ -0,0 +1,94 @@
+#ifndef PSO_H
+#define PSO_H
+
+#include "objective.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------
+// * Particle swarm over D-dimensional positions in structure-of-arrays  *
+// * layout.  Coordinate d of particle i is pos[d*stride + i], so every  *
+// * update is a loop over contiguous arrays which the compiler turns    *
+// * into AVX2/AVX-512 code.  All arrays are aligned to PSO_ALIGN bytes  *
+// * and 'stride' is the particle count padded to a multiple of          *
+// * PSO_CHUNK.  The objective (objective.h) is evaluated once per chunk *
+// * for all particles of the chunk.                                     *
+// *                                                                     *
+// * The particles are split into chunks of PSO_CHUNK particles, each    *
+// * with its own random number stream (rng.h).  A chunk is the unit of  *
+// * work of the parallel drivers, thus the swarm evolves the same no    *
+// * matter how the chunks are distributed over the threads.             *
+// *                                                                     *
+// * Fitness is maximized: for a minimized objective the fitness is the  *
+// * negated value, SwarmBestValue gives the value of gbest.             *
+// -----------------------------------------------------------------------
+
+#define PSO_ALIGN 64
+#define PSO_CHUNK 32           /* a multiple of RNG_LANES */
+#define PSO_MAX_DIM 128
+
+typedef struct tag_swarm{
+    const objective *obj;  /* function to optimize                 */
+    unsigned cnt;          /* number of particles                  */
+    unsigned dim;          /* number of dimensions                 */
+    unsigned stride;       /* padded cnt, distance of coordinates  */
+    double *pos;           /* current position                     */
+    double *vel;           /* current velocity                     */
+    double *fit;           /* fitness of current position          */
+    double *pbest_pos;     /* best position of each particle       */
+    double *pbest_fit;     /* best fitness of each particle        */
+    double *rnd;           /* r1, r2 of each chunk for one step    */
+    struct tag_rng *rng;   /* random stream of each chunk          */
+    double *gbest_pos;     /* best position of the swarm           */
+    double gbest_fit;      /* best fitness of the swarm            */
+}swarm;
+
+/* best particle seen by one thread, 'order' = iteration*cnt + index */
+typedef struct tag_pso_best{
+    double fit;
+    unsigned long long order;
+    unsigned dim;
+    double pos[PSO_MAX_DIM];
+}pso_best;
+
+void   PsoSetParam(double w, double c1, double c2, double v_ratio);
+
+swarm* SwarmAllocate(const objective *obj, unsigned cnt);
+void   SwarmInit(swarm *s, unsigned long long seed);
+void   SwarmInitStreams(swarm *s, struct tag_rng *next);
+void   SwarmMove(swarm *s);
+void   SwarmRelease(swarm *s);
+double SwarmBestValue(const swarm *s);
+
+// building blocks of the parallel drivers, SwarmMove is the serial case
+unsigned SwarmChunks(const swarm *s);
+void   SwarmMoveChunks(swarm *s, unsigned first, unsigned last,
+                       unsigned long long iter, pso_best *best);
+void   SwarmUpdateBest(swarm *s, const pso_best *best);
+void   BestReset(pso_best *best);
+void   BestMerge(pso_best *best, const pso_best *other);
+
+// batches of particles with own random streams for asynchronous PSO
+typedef struct tag_pso_batch{
+    unsigned first, cnt;   /* particles first..first+cnt-1         */
+    struct tag_rng *rng;   /* random stream of the batch           */
+    double *rnd;           /* r1, r2 for one step                  */
+}pso_batch;
+
+pso_batch* SwarmBatches(const swarm *s, unsigned size,
+                        unsigned long long seed, unsigned *cnt);
+void   SwarmMoveBatch(swarm *s, pso_batch *b, const double *gpos,
+                      unsigned long long iter, pso_best *best);
+void   BatchesRelease(pso_batch *b, unsigned cnt);
+
+// migration between the swarms of the island model
+unsigned SwarmEmigrants(const swarm *s, pso_best *out, unsigned cnt);
+int    SwarmImmigrate(swarm *s, const pso_best *migrant);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
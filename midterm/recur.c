@@ -0,0 +1,122 @@
+#include "recur.h"
+
+typedef unsigned long long u64;
+
+// a*b mod p, p = 0: mod 2^64
+static inline u64 MulMod(u64 a, u64 b, u64 p)
+{
+    return p ? (u64)((unsigned __int128)a * b % p) : a * b;
+}
+
+static inline u64 AddMod(u64 a, u64 b, u64 p)
+{
+    return p ? (u64)(((unsigned __int128)a + b) % p) : a + b;
+}
+
+// x mod p of a signed constant
+static inline u64 Residue(long long x, u64 p)
+{
+    if (!p) return (u64)x;
+    return x < 0 ? (p - (u64)(-x) % p) % p : (u64)x % p;
+}
+
+u64 RecurScan(u64 n, u64 p)
+{
+    const u64 m2 = Residue(-2, p), c3 = Residue(3, p), m4 = Residue(-4, p);
+    u64 f0 = 0, f1 = Residue(1, p), f2 = Residue(2, p), f3, i;
+
+    if (n <= 2) return Residue(n, p);
+    for(i=3; i<=n; i++) {
+        f3 = AddMod(AddMod(f2, MulMod(m2, f1, p), p),
+                    AddMod(MulMod(c3, f0, p), m4, p), p);
+        f0 = f1;
+        f1 = f2;
+        f2 = f3;
+    }
+    return f2;
+}
+
+// c = a*b of 3x3 matrices mod p, c may be a or b
+static void MatMul(u64 c[3][3], u64 a[3][3], u64 b[3][3], u64 p)
+{
+    u64 t[3][3];
+    int i, j, k;
+
+    for(i=0; i<3; i++)
+        for(j=0; j<3; j++) {
+            t[i][j] = 0;
+            for(k=0; k<3; k++)
+                t[i][j] = AddMod(t[i][j], MulMod(a[i][k], b[k][j], p), p);
+        }
+    for(i=0; i<3; i++)
+        for(j=0; j<3; j++)
+            c[i][j] = t[i][j];
+}
+
+u64 RecurPower(u64 n, u64 p)
+{
+    // f(n) = g(n) + 4, g(n) = g(n-1) - 2 g(n-2) + 3 g(n-3)
+    u64 m[3][3] = {{Residue(1, p), Residue(-2, p), Residue(3, p)},
+                   {Residue(1, p), 0, 0},
+                   {0, Residue(1, p), 0}};
+    u64 r[3][3] = {{Residue(1, p), 0, 0},
+                   {0, Residue(1, p), 0},
+                   {0, 0, Residue(1, p)}};
+    const u64 g[3] = {Residue(-2, p), Residue(-3, p), Residue(-4, p)};
+    u64 e, gn;
+
+    if (n <= 2) return Residue(n, p);
+    for(e=n-2; e; e>>=1) {
+        if (e & 1) MatMul(r, r, m, p);
+        MatMul(m, m, m, p);
+    }
+    gn = AddMod(AddMod(MulMod(r[0][0], g[0], p), MulMod(r[0][1], g[1], p), p),
+                MulMod(r[0][2], g[2], p), p);
+    return AddMod(gn, Residue(4, p), p);
+}
+
+// fr() in 64 bit, wrapping like RecurScan(n, 0)
+static u64 Serial(int n)
+{
+    if (n <= 2) return n;
+    return Serial(n-1) - 2*Serial(n-2) + 3*Serial(n-3) - 4;
+}
+
+long long RecurSerial(int n)
+{
+    return (long long)Serial(n);
+}
+
+// f(n-1) and f(n-2) are tasks, f(n-3) is done by the calling task
+static u64 Task(int n, task_ctl *c)
+{
+    u64 i, j, k;
+    int id;
+
+    if (n <= 2 || TaskSerial(c, n)) return Serial(n);
+    id = TaskCreate(c);
+#pragma omp task shared(i) final(TaskFinal(c, n-1))
+    {
+        TaskStart(c, id);
+        i = Task(n-1, c);
+    }
+    id = TaskCreate(c);
+#pragma omp task shared(j) final(TaskFinal(c, n-2))
+    {
+        TaskStart(c, id);
+        j = Task(n-2, c);
+    }
+    k = Task(n-3, c);
+#pragma omp taskwait
+    return i - 2*j + 3*k - 4;
+}
+
+long long RecurTasks(int n, task_ctl *c, int threads)
+{
+    u64 f = 0;
+
+#pragma omp parallel num_threads(threads)
+#pragma omp single
+    f = Task(n, c);
+    return (long long)f;
+}
@@ -0,0 +1,37 @@
+#ifndef RECUR_H
+#define RECUR_H
+
+#include "taskctl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------
+// * The recurrence of pb03                                              *
+// *   f(0) = 0, f(1) = 1, f(2) = 2                                      *
+// *   f(n) = f(n-1) - 2 f(n-2) + 3 f(n-3) - 4                           *
+// * evaluated without the exponential recursion of fr().  The results   *
+// * are residues modulo p, where p = 0 stands for 2^64: cast to long    *
+// * long they are f(n) itself as long as it fits, up to n = 101 since   *
+// * |f(n)| grows about like 1.53^n, and wrap around in two's complement *
+// * beyond.                                                             *
+// *   RecurScan   O(n), a loop over the last three values               *
+// *   RecurPower  O(log n).  g = f - 4 is a linear recurrence, so       *
+// *               (g(n), g(n-1), g(n-2)) = M^(n-2) (g(2), g(1), g(0))   *
+// *               with the 3x3 companion matrix M, raised by squaring   *
+// *   RecurSerial the recursion of fr() in 64 bit, exponential          *
+// *   RecurTasks  the same as OpenMP tasks, split as 'c' (taskctl.h)    *
+// *               decides; only for comparing with fr() and fr_omp()    *
+// -----------------------------------------------------------------------
+
+unsigned long long RecurScan(unsigned long long n, unsigned long long p);
+unsigned long long RecurPower(unsigned long long n, unsigned long long p);
+long long          RecurSerial(int n);
+long long          RecurTasks(int n, task_ctl *c, int threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,111 @@
+#include <string.h>
+#include "rng.h"
+
+typedef unsigned long long u64v __attribute__((vector_size(RNG_LANES*8)));
+typedef double f64v __attribute__((vector_size(RNG_LANES*8)));
+
+static const unsigned long long jump[4] = {
+    0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull,
+    0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+
+static const unsigned long long long_jump[4] = {
+    0x76e15d3efefdcbbfull, 0xc5004e441c522fb3ull,
+    0x77710069854ee241ull, 0x39109bb02acbe635ull };
+
+static unsigned long long splitmix(unsigned long long *x)
+{
+    unsigned long long z = (*x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// one step of a single xoshiro256+ state
+static void Step(unsigned long long s[4])
+{
+    unsigned long long t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+}
+
+// advance 's' by the polynomial 'poly', i.e. 2^128 or 2^192 steps
+static void Jump(unsigned long long s[4], const unsigned long long poly[4])
+{
+    unsigned long long t[4] = { 0, 0, 0, 0 };
+    int i, b, k;
+    for(i=0; i<4; i++)
+        for(b=0; b<64; b++) {
+            if(poly[i] & (1ull << b))
+                for(k=0; k<4; k++)
+                    t[k] ^= s[k];
+            Step(s);
+        }
+    memcpy(s, t, sizeof t);
+}
+
+void RngSeed(rng *r, unsigned long long seed)
+{
+    unsigned long long s[4];
+    int k, l;
+    for(k=0; k<4; k++)
+        s[k] = splitmix(&seed);
+    for(l=0; l<RNG_LANES; l++) {
+        for(k=0; k<4; k++)
+            r->s[k][l] = s[k];
+        Jump(s, jump);
+    }
+}
+
+void RngSplit(rng *next, const rng *r)
+{
+    unsigned long long s[4];
+    int k, l;
+    for(l=0; l<RNG_LANES; l++) {
+        for(k=0; k<4; k++)
+            s[k] = r->s[k][l];
+        Jump(s, long_jump);
+        for(k=0; k<4; k++)
+            next->s[k][l] = s[k];
+    }
+}
+
+// -----------------------------------------------------------------------
+// * Fill 'out' with 'n' uniform numbers in [0,1), 'n' a multiple of     *
+// * RNG_LANES.  The upper 52 bits are turned into a double in [1,2) by  *
+// * setting the exponent, which needs no 64 bit integer to double       *
+// * conversion (missing in AVX2).                                       *
+// -----------------------------------------------------------------------
+
+void RngUniform(rng *r, double *out, unsigned n)
+{
+    u64v s0, s1, s2, s3, x, t;
+    f64v d;
+    unsigned i;
+
+    memcpy(&s0, r->s[0], sizeof s0);
+    memcpy(&s1, r->s[1], sizeof s1);
+    memcpy(&s2, r->s[2], sizeof s2);
+    memcpy(&s3, r->s[3], sizeof s3);
+    for(i=0; i<n; i+=RNG_LANES) {
+        x = s0 + s3;
+        t = s1 << 17;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = (s3 << 45) | (s3 >> 19);
+        x = (x >> 12) | 0x3ff0000000000000ull;
+        memcpy(&d, &x, sizeof d);
+        d -= 1.0;
+        memcpy(out + i, &d, sizeof d);
+    }
+    memcpy(r->s[0], &s0, sizeof s0);
+    memcpy(r->s[1], &s1, sizeof s1);
+    memcpy(r->s[2], &s2, sizeof s2);
+    memcpy(r->s[3], &s3, sizeof s3);
+}
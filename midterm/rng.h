@@ -0,0 +1,33 @@
+#ifndef RNG_H
+#define RNG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------
+// * Reproducible parallel random numbers: RNG_LANES xoshiro256+         *
+// * generators stepped together in GCC vectors, which fill whole        *
+// * buffers of uniform doubles at once.  Lane l of a generator seeded   *
+// * with RngSeed starts l*2^128 steps after the seed state (jump), and  *
+// * RngSplit gives the next stream, 2^192 steps further (long jump).    *
+// * Thus the streams never overlap, and giving stream k to chunk k of   *
+// * the work, not to thread k, makes the numbers independent of the     *
+// * thread count.  No locks, no global state: each thread owns its rng. *
+// -----------------------------------------------------------------------
+
+#define RNG_LANES 8
+
+typedef struct tag_rng{
+    unsigned long long s[4][RNG_LANES] __attribute__((aligned(64)));
+}rng;
+
+void RngSeed(rng *r, unsigned long long seed);
+void RngSplit(rng *next, const rng *r);
+void RngUniform(rng *r, double *out, unsigned n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef SLOTS_H
+#define SLOTS_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------
+// * Per-thread reduction slots.  Each thread keeps its partial result   *
+// * (e.g. its best point so far) in its own slot and the slots are      *
+// * merged once at the end.  A slot starts on a cache line and its size *
+// * is rounded up to whole lines, so a thread writing its slot in the   *
+// * hot loop never invalidates the line of another thread (no false     *
+// * sharing), which a packed array like double themin[num] does.        *
+// *                                                                     *
+// * SlotsMerge folds the slots in thread order with a merge function;   *
+// * ArgMin/ArgMax are merge functions for the common (value, argument)  *
+// * pair, on equal values they keep the smaller argument.               *
+// -----------------------------------------------------------------------
+
+#define SLOT_LINE 64
+
+typedef struct tag_slots{
+    char *mem;
+    size_t size;                       /* bytes per slot           */
+    unsigned cnt;                      /* number of slots          */
+}slots;
+
+typedef struct tag_argval{
+    double val;
+    unsigned long long arg;
+}argval;
+
+// 'cnt' zeroed slots for elements of 'elem' bytes
+static inline void SlotsInit(slots *s, unsigned cnt, size_t elem)
+{
+    s->size = (elem + SLOT_LINE - 1) / SLOT_LINE * SLOT_LINE;
+    s->cnt = cnt;
+    s->mem = (char*)aligned_alloc(SLOT_LINE, s->size * cnt);
+    memset(s->mem, 0, s->size * cnt);
+}
+
+static inline void SlotsRelease(slots *s)
+{
+    free(s->mem);
+}
+
+static inline void* Slot(const slots *s, unsigned i)
+{
+    return s->mem + s->size * i;
+}
+
+// merge slots 0..cnt-1 in this order into 'out', which is initialized
+// by the caller, e.g. as a copy of slot 0
+static inline void SlotsMerge(const slots *s, void *out,
+                              void (*merge)(void *best, const void *other))
+{
+    unsigned i;
+    for (i = 0; i < s->cnt; i++)
+        merge(out, Slot(s, i));
+}
+
+static inline void ArgMin(void *best, const void *other)
+{
+    argval *b = (argval*)best;
+    const argval *o = (const argval*)other;
+    if (o->val < b->val || (o->val == b->val && o->arg < b->arg))
+        *b = *o;
+}
+
+static inline void ArgMax(void *best, const void *other)
+{
+    argval *b = (argval*)best;
+    const argval *o = (const argval*)other;
+    if (o->val > b->val || (o->val == b->val && o->arg < b->arg))
+        *b = *o;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
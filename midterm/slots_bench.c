@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "slots.h"
+#include "timing.h"
+
+// -----------------------------------------------------------------------
+// * False sharing of per-thread results.  Every thread runs an argmin   *
+// * over its own range in which every point is an improvement (the      *
+// * worst case, like lbest of the PSO) and stores it after each point,  *
+// * once into a packed argval array (four threads per cache line) and   *
+// * once into padded slots of slots.h.  Both are merged with ArgMin.    *
+// * Usage: ./slots_bench [updates per thread] [max threads]             *
+// -----------------------------------------------------------------------
+
+typedef struct tag_job{
+    volatile argval *out;          /* this thread's result         */
+    unsigned long long first, cnt;
+}job;
+
+unsigned long long updates = 10000000;
+
+void *threadScan(void *arg)
+{
+    job *j = (job*)arg;
+    unsigned long long i;
+
+    for (i = j->first; i < j->first + j->cnt; i++) {
+        double v = -(double)i;
+        if (v < j->out->val) {
+            j->out->val = v;
+            j->out->arg = i;
+        }
+    }
+    return NULL;
+}
+
+// run 'num' threads on the results out(k), returns the seconds taken
+double Run(int num, volatile argval *(*out)(void *, int), void *base,
+           argval *best)
+{
+    pthread_t *thread_p = (pthread_t*)malloc(num * sizeof(pthread_t));
+    job *jobs = (job*)malloc(num * sizeof(job));
+    double start;
+    int i;
+
+    for (i = 0; i < num; i++) {
+        jobs[i].out = out(base, i);
+        jobs[i].out->val = 0.0;
+        jobs[i].out->arg = ~0ull;
+        jobs[i].first = i * updates;
+        jobs[i].cnt = updates;
+    }
+    start = WallTime();
+    for (i = 0; i < num; i++)
+        pthread_create(&thread_p[i], NULL, threadScan, &jobs[i]);
+    for (i = 0; i < num; i++)
+        pthread_join(thread_p[i], NULL);
+    start = WallTime() - start;
+
+    best->val = 0.0;
+    best->arg = ~0ull;
+    for (i = 0; i < num; i++)
+        ArgMin(best, (const void*)out(base, i));
+    free(thread_p);
+    free(jobs);
+    return start;
+}
+
+volatile argval *Packed(void *base, int i)
+{
+    return (argval*)base + i;
+}
+
+volatile argval *Padded(void *base, int i)
+{
+    return (argval*)Slot((slots*)base, i);
+}
+
+int main(int argc, char *argv[])
+{
+    int num, max_num = 32;
+    double packed_sec, padded_sec;
+    argval *packed, best1, best2;
+    slots padded;
+
+    if (argc > 1) updates = strtoull(argv[1], 0, 10);
+    if (argc > 2) max_num = atoi(argv[2]);
+    if (argc > 3 || !updates || max_num <= 0) {
+        printf("Usage: ./slots_bench [updates per thread] [max threads]\n");
+        exit(1);
+    }
+
+    printf("%llu updates per thread\n", updates);
+    printf("threads   packed ns/update   padded ns/update   speedup\n");
+    for (num = 1; num <= max_num; num *= 2) {
+        packed = (argval*)aligned_alloc(SLOT_LINE, (num * sizeof(argval) +
+                                        SLOT_LINE - 1) / SLOT_LINE * SLOT_LINE);
+        SlotsInit(&padded, num, sizeof(argval));
+        packed_sec = Run(num, Packed, packed, &best1);
+        padded_sec = Run(num, Padded, &padded, &best2);
+        if (best1.arg != best2.arg)
+            printf("results differ: %llu %llu\n", best1.arg, best2.arg);
+        printf("%7d   %16.3lf   %16.3lf   %7.2lf\n", num,
+               packed_sec * 1e9 / updates, padded_sec * 1e9 / updates,
+               packed_sec / padded_sec);
+        free(packed);
+        SlotsRelease(&padded);
+    }
+    return 0;
+}
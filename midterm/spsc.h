@@ -0,0 +1,68 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------
+// * Lock-free bounded queue for exactly one producer and one consumer   *
+// * thread.  'tail' is only written by the producer and 'head' only by  *
+// * the consumer, each on its own cache line.  An element is copied in  *
+// * before 'tail' is released, so the consumer that acquires 'tail'     *
+// * sees it completely.  Both ends never block: SpscPush returns 0 if   *
+// * the queue is full and SpscPop returns 0 if it is empty.             *
+// -----------------------------------------------------------------------
+
+typedef struct tag_spsc{
+    unsigned cap;                      /* capacity, a power of two */
+    unsigned size;                     /* size of one element      */
+    char *buf;
+    unsigned head __attribute__((aligned(64)));  /* next to pop  */
+    unsigned tail __attribute__((aligned(64)));  /* next to push */
+}spsc;
+
+static inline void SpscInit(spsc *q, unsigned cap, unsigned size)
+{
+    unsigned c = 1;
+    while (c < cap)
+        c *= 2;
+    q->cap = c;
+    q->size = size;
+    q->buf = (char*)malloc((size_t)c * size);
+    q->head = q->tail = 0;
+}
+
+static inline void SpscRelease(spsc *q)
+{
+    free(q->buf);
+}
+
+static inline int SpscPush(spsc *q, const void *elem)
+{
+    unsigned tail = q->tail;
+    if (tail - __atomic_load_n(&q->head, __ATOMIC_ACQUIRE) == q->cap)
+        return 0;
+    memcpy(q->buf + (size_t)(tail & (q->cap - 1)) * q->size, elem, q->size);
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+static inline int SpscPop(spsc *q, void *elem)
+{
+    unsigned head = q->head;
+    if (head == __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE))
+        return 0;
+    memcpy(elem, q->buf + (size_t)(head & (q->cap - 1)) * q->size, q->size);
+    __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <omp.h>
+#include "recur.h"
+
+// -----------------------------------------------------------------------
+// * Task overhead of the pb03 recursion: RecurSerial against RecurTasks *
+// * in the three modes of taskctl.h for n = lo, lo+step, .., hi.  The   *
+// * overhead is the time over the serial one per task, created or       *
+// * included.  Usage: ./task_bench [-t threads] [-c cutoff] [lo hi step] *
+// -----------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    int threads = omp_get_max_threads(), cutoff = 20, opt;
+    int lo = 16, hi = 26, step = 2, n, mode;
+    double start, serial, sec;
+    long long f0, f;
+    task_stats st;
+    task_ctl c;
+
+    while ((opt = getopt(argc, argv, "t:c:")) != -1) {
+        switch (opt) {
+            case 't': threads = atoi(optarg); break;
+            case 'c': cutoff = atoi(optarg); break;
+            default: threads = 0;
+        }
+    }
+    if (argc - optind == 3) {
+        lo = atoi(argv[optind]);
+        hi = atoi(argv[optind + 1]);
+        step = atoi(argv[optind + 2]);
+    }
+    if ((argc - optind != 0 && argc - optind != 3) || threads <= 0 ||
+        step <= 0 || lo < 0) {
+        printf("Usage: ./task_bench [-t threads] [-c cutoff] [lo hi step]\n");
+        exit(1);
+    }
+
+    printf("%d threads, cutoff %d\n", threads, cutoff);
+    printf(" n  mode      sec     speedup      created     included"
+           "       stolen  overhead/task\n");
+    for(n=lo; n<=hi; n+=step) {
+        start = omp_get_wtime();
+        f0 = RecurSerial(n);
+        serial = omp_get_wtime() - start;
+        printf("%2d  serial %9.6f\n", n, serial);
+        for(mode=TASK_ALL; mode<=TASK_FINAL; mode++) {
+            TaskCtlInit(&c, mode, cutoff, threads);
+            start = omp_get_wtime();
+            f = RecurTasks(n, &c, threads);
+            sec = omp_get_wtime() - start;
+            TaskStats(&c, &st);
+            TaskCtlRelease(&c);
+            printf("%2d  %-6s %9.6f %8.3f %12llu %12llu %12llu", n,
+                   task_mode[mode], sec, serial / sec, st.created,
+                   st.included, st.stolen);
+            if (st.created + st.included)
+                printf(" %11.1f ns", (sec - serial) * 1e9 /
+                       (st.created + st.included));
+            printf("%s\n", f == f0 ? "" : "  WRONG");
+        }
+    }
+    return 0;
+}
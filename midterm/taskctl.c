@@ -0,0 +1,30 @@
+#include "taskctl.h"
+
+const char *task_mode[] = { "all", "cutoff", "final" };
+
+// 'threads' is at least the size of the team running the tasks
+void TaskCtlInit(task_ctl *c, int mode, int cutoff, int threads)
+{
+    c->mode = mode;
+    c->cutoff = cutoff;
+    SlotsInit(&c->stats, threads, sizeof(task_stats));
+}
+
+void TaskCtlRelease(task_ctl *c)
+{
+    SlotsRelease(&c->stats);
+}
+
+void TaskStats(const task_ctl *c, task_stats *sum)
+{
+    const task_stats *p;
+    unsigned i;
+
+    sum->created = sum->included = sum->stolen = 0;
+    for(i=0; i<c->stats.cnt; i++) {
+        p = (const task_stats*)Slot(&c->stats, i);
+        sum->created += p->created;
+        sum->included += p->included;
+        sum->stolen += p->stolen;
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef TASKCTL_H
+#define TASKCTL_H
+
+#include <omp.h>
+#include "slots.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------
+// * Granularity control of recursive OpenMP tasks.  A recursion that    *
+// * makes every call a task pays the task overhead for calls that do    *
+// * almost no work; task_ctl decides which calls become tasks:          *
+// *   TASK_ALL     every call (fr_omp of the homework)                  *
+// *   TASK_CUTOFF  calls of size <= cutoff run the serial code instead  *
+// *   TASK_FINAL   calls of size <= cutoff are final tasks, so all of   *
+// *                their descendants are included (run at once by the   *
+// *                creating thread), the recursive code stays the same  *
+// * The recursion asks TaskSerial() whether to switch to the serial     *
+// * code and puts final(TaskFinal()) on its task constructs.  It calls  *
+// * TaskCreate() right before a task construct and TaskStart() first in *
+// * the task, which count in the slot of the thread (slots.h):          *
+// *   created   deferred tasks      included  tasks run at once (final) *
+// *   stolen    tasks run by another thread than the one creating them  *
+// -----------------------------------------------------------------------
+
+enum { TASK_ALL, TASK_CUTOFF, TASK_FINAL };
+
+extern const char *task_mode[];
+
+typedef struct tag_task_stats{
+    unsigned long long created, included, stolen;
+}task_stats;
+
+typedef struct tag_task_ctl{
+    int mode;
+    int cutoff;                        /* largest size not split     */
+    slots stats;                       /* task_stats of every thread */
+}task_ctl;
+
+void TaskCtlInit(task_ctl *c, int mode, int cutoff, int threads);
+void TaskCtlRelease(task_ctl *c);
+void TaskStats(const task_ctl *c, task_stats *sum);
+
+static inline int TaskSerial(const task_ctl *c, int size)
+{
+    return c->mode == TASK_CUTOFF && size <= c->cutoff;
+}
+
+static inline int TaskFinal(const task_ctl *c, int size)
+{
+    return c->mode == TASK_FINAL && size <= c->cutoff;
+}
+
+// by the creating thread, returns its number for TaskStart
+static inline int TaskCreate(task_ctl *c)
+{
+    int id = omp_get_thread_num();
+    task_stats *mine = (task_stats*)Slot(&c->stats, id);
+    if (omp_in_final()) mine->included++;
+    else mine->created++;
+    return id;
+}
+
+static inline void TaskStart(task_ctl *c, int parent)
+{
+    int id = omp_get_thread_num();
+    if (id != parent)
+        ((task_stats*)Slot(&c->stats, id))->stolen++;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
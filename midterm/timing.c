@@ -0,0 +1,84 @@
+#include <time.h>
+#include "timing.h"
+
+double WallTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+static double ThreadCpu(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+void TimingInit(timing *t, const char *prog, int threads)
+{
+    t->prog = prog;
+    t->threads = threads;
+    t->start = t->wall = 0.0;
+    SlotsInit(&t->per, threads, sizeof(thread_time));
+}
+
+void TimingStart(timing *t)
+{
+    t->start = WallTime();
+}
+
+void TimingStop(timing *t)
+{
+    t->wall = WallTime() - t->start;
+}
+
+// called by thread 'id' before some work ...
+void TimingBegin(timing *t, int id)
+{
+    thread_time *mine = (thread_time*)Slot(&t->per, id);
+    mine->begin = WallTime();
+    mine->cpu_begin = ThreadCpu();
+}
+
+// ... and after it, with the number of items it took
+void TimingEnd(timing *t, int id, unsigned long long items)
+{
+    thread_time *mine = (thread_time*)Slot(&t->per, id);
+    mine->busy += WallTime() - mine->begin;
+    mine->cpu += ThreadCpu() - mine->cpu_begin;
+    mine->items += items;
+}
+
+void TimingReport(const timing *t, FILE *out)
+{
+    double busy_max = 0.0, busy_sum = 0.0, cpu = 0.0, mean;
+    unsigned long long items = 0;
+    const thread_time *p;
+    int i;
+
+    for(i=0; i<t->threads; i++) {
+        p = (const thread_time*)Slot(&t->per, i);
+        if (p->busy > busy_max) busy_max = p->busy;
+        busy_sum += p->busy;
+        cpu += p->cpu;
+        items += p->items;
+    }
+    mean = busy_sum / t->threads;
+    fprintf(out, "timing prog=%s threads=%d wall=%.6f items=%llu rate=%.6g "
+            "busy_max=%.6f busy_mean=%.6f imbalance=%.4f cpu=%.6f "
+            "utilization=%.4f\n", t->prog, t->threads, t->wall, items,
+            t->wall > 0 ? items / t->wall : 0.0, busy_max, mean,
+            mean > 0 ? busy_max / mean - 1 : 0.0, cpu,
+            t->wall > 0 ? busy_sum / (t->threads * t->wall) : 0.0);
+    for(i=0; i<t->threads; i++) {
+        p = (const thread_time*)Slot(&t->per, i);
+        fprintf(out, "thread id=%d busy=%.6f cpu=%.6f items=%llu\n",
+                i, p->busy, p->cpu, p->items);
+    }
+}
+
+void TimingRelease(timing *t)
+{
+    SlotsRelease(&t->per);
+}
@@ -0,0 +1,52 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdio.h>
+#include "slots.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------
+// * Wall clock timing of a parallel run.  The run is timed with the     *
+// * monotonic clock; clock() adds up the CPU time of all threads and    *
+// * says nothing about the elapsed time.  Every thread brackets its     *
+// * work with TimingBegin/TimingEnd, which accumulate in the slot of    *
+// * the thread (slots.h) its busy (wall) time, its CPU time and the     *
+// * number of items it processed.  TimingReport prints one line of      *
+// * key=value pairs for the run and one for each thread:                *
+// *   timing prog=.. threads=.. wall=.. items=.. rate=.. busy_max=..    *
+// *          busy_mean=.. imbalance=.. cpu=.. utilization=..            *
+// *   thread id=.. busy=.. cpu=.. items=..                              *
+// * imbalance is busy_max/busy_mean - 1 (0: perfectly balanced) and     *
+// * utilization the busy time of all threads over threads*wall.         *
+// -----------------------------------------------------------------------
+
+typedef struct tag_thread_time{
+    double begin, busy;              /* wall time, seconds             */
+    double cpu_begin, cpu;           /* CPU time of the thread         */
+    unsigned long long items;
+}thread_time;
+
+typedef struct tag_timing{
+    const char *prog;
+    int threads;
+    double start, wall;              /* wall time of the run           */
+    slots per;                       /* thread_time of every thread    */
+}timing;
+
+double WallTime(void);
+void   TimingInit(timing *t, const char *prog, int threads);
+void   TimingStart(timing *t);
+void   TimingStop(timing *t);
+void   TimingBegin(timing *t, int id);
+void   TimingEnd(timing *t, int id, unsigned long long items);
+void   TimingReport(const timing *t, FILE *out);
+void   TimingRelease(timing *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,207 @@
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+#include "dgemm.h"
+
+#define MR DGEMM_MR
+#define NR DGEMM_NR
+#define KC DGEMM_KC
+#define MC DGEMM_MC
+#define NC DGEMM_NC
+#define ALIGN 64
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+double* MatAlloc(int rows, int cols)
+{
+    size_t bytes = ((size_t)rows * cols * sizeof(double) + ALIGN - 1)
+                   / ALIGN * ALIGN;
+    double *a = (double*)aligned_alloc(ALIGN, bytes ? bytes : ALIGN);
+    if (a) memset(a, 0, bytes);
+    return a;
+}
+
+void MatFree(double *a)
+{
+    free(a);
+}
+
+void DgemmNaive(int m, int n, int k, const double *A, int lda,
+                const double *B, int ldb, double *C, int ldc)
+{
+    int i, j, p;
+    for(i=0; i<m; i++)
+        for(p=0; p<k; p++)
+            for(j=0; j<n; j++)
+                C[(size_t)i*ldc + j] += A[(size_t)i*lda + p] * B[(size_t)p*ldb + j];
+}
+
+// mc x kc block of A into MR-row panels, a panel holds for every p the
+// MR values of column p; missing rows are zero
+static void PackA(int mc, int kc, const double *A, int lda, double *pa)
+{
+    int i, p, r, rows;
+    for(i=0; i<mc; i+=MR) {
+        rows = MIN(MR, mc - i);
+        for(p=0; p<kc; p++) {
+            for(r=0; r<rows; r++)
+                pa[r] = A[(size_t)(i + r)*lda + p];
+            for(; r<MR; r++)
+                pa[r] = 0.0;
+            pa += MR;
+        }
+    }
+}
+
+// kc x nc block of B into NR-column panels, panels first..last-1 of it
+static void PackB(int kc, int nc, const double *B, int ldb, double *pb,
+                  int first, int last)
+{
+    int j, p, c, cols, q;
+    for(q=first; q<last; q++) {
+        double *dst = pb + (size_t)q*kc*NR;
+        j = q * NR;
+        cols = MIN(NR, nc - j);
+        for(p=0; p<kc; p++) {
+            const double *src = B + (size_t)p*ldb + j;
+            for(c=0; c<cols; c++)
+                dst[c] = src[c];
+            for(; c<NR; c++)
+                dst[c] = 0.0;
+            dst += NR;
+        }
+    }
+}
+
+// MR x NR tile c (row stride ldc) += panel a * panel b
+static void Kernel(int kc, const double *a, const double *b, double *c,
+                   int ldc)
+{
+    int p, r;
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256d acc[MR][2], b0, b1, ar;
+
+    for(r=0; r<MR; r++)
+        acc[r][0] = acc[r][1] = _mm256_setzero_pd();
+#pragma GCC unroll 4
+    for(p=0; p<kc; p++) {
+        b0 = _mm256_load_pd(b);
+        b1 = _mm256_load_pd(b + 4);
+        for(r=0; r<MR; r++) {
+            ar = _mm256_broadcast_sd(a + r);
+            acc[r][0] = _mm256_fmadd_pd(ar, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_pd(ar, b1, acc[r][1]);
+        }
+        a += MR;
+        b += NR;
+    }
+    for(r=0; r<MR; r++) {
+        double *cr = c + (size_t)r*ldc;
+        _mm256_storeu_pd(cr, _mm256_add_pd(_mm256_loadu_pd(cr), acc[r][0]));
+        _mm256_storeu_pd(cr + 4, _mm256_add_pd(_mm256_loadu_pd(cr + 4), acc[r][1]));
+    }
+#else
+    double acc[MR][NR] = {{0}};
+    int j;
+
+    for(p=0; p<kc; p++) {
+        for(r=0; r<MR; r++)
+            for(j=0; j<NR; j++)
+                acc[r][j] += a[r] * b[j];
+        a += MR;
+        b += NR;
+    }
+    for(r=0; r<MR; r++)
+        for(j=0; j<NR; j++)
+            c[(size_t)r*ldc + j] += acc[r][j];
+#endif
+}
+
+// mc x nc block of C += packed A * packed B
+static void Macro(int mc, int nc, int kc, const double *pa, const double *pb,
+                  double *C, int ldc)
+{
+    double tile[MR*NR];
+    int i, j, r, q, rows, cols;
+
+    for(j=0; j<nc; j+=NR) {
+        cols = MIN(NR, nc - j);
+        for(i=0; i<mc; i+=MR) {
+            rows = MIN(MR, mc - i);
+            const double *a = pa + (size_t)i*kc, *b = pb + (size_t)j*kc;
+            double *c = C + (size_t)i*ldc + j;
+            if (rows == MR && cols == NR) {
+                Kernel(kc, a, b, c, ldc);
+                continue;
+            }
+            memset(tile, 0, sizeof(tile));
+            Kernel(kc, a, b, tile, NR);
+            for(r=0; r<rows; r++)
+                for(q=0; q<cols; q++)
+                    c[(size_t)r*ldc + q] += tile[r*NR + q];
+        }
+    }
+}
+
+void Dgemm(int m, int n, int k, const double *A, int lda,
+           const double *B, int ldb, double *C, int ldc, int threads)
+{
+    const int ncmax = MIN(NC, (n + NR - 1) / NR * NR);
+    const int blocks = (m + MC - 1) / MC;
+    double *pb, *pas;
+
+    if (m <= 0 || n <= 0 || k <= 0) return;
+    if (threads < 1) threads = 1;
+    pb = MatAlloc(KC, ncmax);
+    pas = MatAlloc(threads * MC, KC);
+    if (!pb || !pas) {
+        // no memory for the packed blocks, the naive loop needs none
+        MatFree(pb);
+        MatFree(pas);
+        DgemmNaive(m, n, k, A, lda, B, ldb, C, ldc);
+        return;
+    }
+
+#pragma omp parallel num_threads(threads)
+    {
+        const int t = omp_get_thread_num(), nt = omp_get_num_threads();
+        double *pa = pas + (size_t)t*MC*KC;
+        int jc, pc, nc, kc, panels, splits, w, packed;
+
+        for(jc=0; jc<n; jc+=NC) {
+            nc = MIN(NC, n - jc);
+            panels = (nc + NR - 1) / NR;
+            // fewer MC row blocks than threads: the panels of B of a
+            // block are split among threads too, each packs the A it needs
+            splits = blocks < nt ? MIN((nt + blocks - 1) / blocks, panels) : 1;
+            for(pc=0; pc<k; pc+=KC) {
+                kc = MIN(KC, k - pc);
+                // every thread packs its share of the panels of B, the
+                // barrier at the end of the loop also keeps B until all
+                // threads are done with the previous one
+#pragma omp barrier
+                PackB(kc, nc, B + (size_t)pc*ldb + jc, ldb, pb,
+                      panels * t / nt, panels * (t + 1) / nt);
+#pragma omp barrier
+                packed = -1;
+#pragma omp for schedule(dynamic) nowait
+                for(w=0; w<blocks*splits; w++) {
+                    int ic = w / splits * MC, mc = MIN(MC, m - ic);
+                    int j0 = panels * (w % splits) / splits * NR;
+                    int j1 = MIN(nc, panels * (w % splits + 1) / splits * NR);
+                    if (ic != packed) {
+                        PackA(mc, kc, A + (size_t)ic*lda + pc, lda, pa);
+                        packed = ic;
+                    }
+                    Macro(mc, j1 - j0, kc, pa, pb + (size_t)j0*kc,
+                          C + (size_t)ic*ldc + jc + j0, ldc);
+                }
+            }
+        }
+    }
+    MatFree(pas);
+    MatFree(pb);
+}
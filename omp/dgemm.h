@@ -0,0 +1,45 @@
+#ifndef DGEMM_H
+#define DGEMM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// -----------------------------------------------------------------------
+// * C += A*B for row-major double matrices of any size, A m x k, B k x  *
+// * n, C m x n, with leading dimensions (row strides) lda, ldb, ldc.    *
+// * The loops are blocked for the caches as in GotoBLAS:                *
+// *   jc  NC columns of B and C                                         *
+// *   pc  KC rows of B, packed into NR-column panels (stays in L3)      *
+// *   ic  MC rows of A, packed into MR-row panels   (stays in L2)       *
+// *   jr/ir  MR x NR tiles of C computed by the micro-kernel, which     *
+// *       keeps the tile in registers and streams a KC x NR panel of B  *
+// *       through L1.                                                   *
+// * With AVX2 and FMA the micro-kernel is a 6 x 8 tile in twelve ymm    *
+// * registers, otherwise plain C.  Packing pads the panels with zeros,  *
+// * so ragged edges go through the same kernel into a scratch tile.     *
+// * The threads pack B together and then take MC x NC blocks of C, one  *
+// * at a time (dynamic schedule), each with its own packed A.  With     *
+// * fewer blocks than threads the panels of a block are split among     *
+// * threads too.  threads < 1 runs one thread; if the packed blocks     *
+// * can not be allocated the naive loop computes C.                     *
+// -----------------------------------------------------------------------
+
+#define DGEMM_MR    6
+#define DGEMM_NR    8
+#define DGEMM_KC  384
+#define DGEMM_MC   96                  /* multiple of DGEMM_MR */
+#define DGEMM_NC 4096                  /* multiple of DGEMM_NR */
+
+double* MatAlloc(int rows, int cols);  /* 64 byte aligned, zeroed */
+void    MatFree(double *a);
+void    Dgemm(int m, int n, int k, const double *A, int lda,
+              const double *B, int ldb, double *C, int ldc, int threads);
+void    DgemmNaive(int m, int n, int k, const double *A, int lda,
+                   const double *B, int ldb, double *C, int ldc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
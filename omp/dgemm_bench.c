@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <omp.h>
+#include "dgemm.h"
+
+// -----------------------------------------------------------------------
+// * GFLOPS of Dgemm for square matrices of the given sizes (default     *
+// * 512 1024 2048 4096), best of 'reps' runs, and of the naive i-k-j    *
+// * loop up to size 1024.  Every result is checked on 64 entries        *
+// * against a dot product.                                              *
+// * Usage: ./dgemm_bench [-t threads] [-r reps] [size ..]               *
+// -----------------------------------------------------------------------
+
+// largest relative error of C = A*B on 64 sample entries
+double Check(int n, const double *A, const double *B, const double *C)
+{
+    double err = 0.0, dot, e;
+    int s, i, j, p;
+
+    for(s=0; s<64; s++) {
+        i = rand() % n;
+        j = rand() % n;
+        dot = 0.0;
+        for(p=0; p<n; p++)
+            dot += A[(size_t)i*n + p] * B[(size_t)p*n + j];
+        e = fabs(C[(size_t)i*n + j] - dot) / (fabs(dot) + 1e-300);
+        if (e > err) err = e;
+    }
+    return err;
+}
+
+int main(int argc, char *argv[])
+{
+    static const int sizes[] = { 512, 1024, 2048, 4096 };
+    int threads = omp_get_max_threads(), reps = 3, opt, cnt, s, r, n;
+    double *A, *B, *C, start, sec, best, flops;
+    size_t i;
+
+    while ((opt = getopt(argc, argv, "t:r:")) != -1) {
+        switch (opt) {
+            case 't': threads = atoi(optarg); break;
+            case 'r': reps = atoi(optarg); break;
+            default: threads = 0;
+        }
+    }
+    if (threads <= 0 || reps <= 0) {
+        printf("Usage: ./dgemm_bench [-t threads] [-r reps] [size ..]\n");
+        exit(1);
+    }
+    cnt = argc > optind ? argc - optind : 4;
+
+    printf("%d threads, best of %d\n", threads, reps);
+    printf("   size   Dgemm sec   GFLOPS    naive sec   GFLOPS   rel. error\n");
+    for(s=0; s<cnt; s++) {
+        n = argc > optind ? atoi(argv[optind + s]) : sizes[s];
+        if (n <= 0) continue;
+        A = MatAlloc(n, n);
+        B = MatAlloc(n, n);
+        C = MatAlloc(n, n);
+        for(i=0; i<(size_t)n*n; i++) {
+            A[i] = (double)rand() / RAND_MAX - 0.5;
+            B[i] = (double)rand() / RAND_MAX - 0.5;
+        }
+        flops = 2.0 * n * n * n;
+
+        best = HUGE_VAL;
+        for(r=0; r<reps; r++) {
+            for(i=0; i<(size_t)n*n; i++) C[i] = 0.0;
+            start = omp_get_wtime();
+            Dgemm(n, n, n, A, n, B, n, C, n, threads);
+            sec = omp_get_wtime() - start;
+            if (sec < best) best = sec;
+        }
+        printf("%7d %11.4f %8.2f", n, best, flops / best / 1e9);
+
+        if (n <= 1024) {
+            for(i=0; i<(size_t)n*n; i++) C[i] = 0.0;
+            start = omp_get_wtime();
+            DgemmNaive(n, n, n, A, n, B, n, C, n);
+            sec = omp_get_wtime() - start;
+            printf(" %12.4f %8.2f", sec, flops / sec / 1e9);
+            // the check below is on the Dgemm result again
+            for(i=0; i<(size_t)n*n; i++) C[i] = 0.0;
+            Dgemm(n, n, n, A, n, B, n, C, n, threads);
+        }
+        else
+            printf(" %12s %8s", "-", "-");
+        printf("   %.2e\n", Check(n, A, B, C));
+        MatFree(A);
+        MatFree(B);
+        MatFree(C);
+    }
+    return 0;
+}
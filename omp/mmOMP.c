@@ -1,71 +1,72 @@
-/******************************************************************************
-* FILE: omp_mm.c * AUTHOR: Blaise Barney * LAST REVISED: 06/28/05
-******************************************************************************/
-#include <omp.h>
-#include <stdio.h>
-#include <stdlib.h>
-
-#define NRA 8                  /* number of rows in matrix A */
-#define NCA 10                 /* number of columns in matrix A */
-#define NCB 5                  /* number of columns in matrix B */
-
-int main() 
-{
-int	tid, nthreads, i, j, k, chunk;
-double	a[NRA][NCA],           /* matrix A to be multiplied */
-	b[NCA][NCB],           /* matrix B to be multiplied */
-	c[NRA][NCB];           /* result matrix C */
-
-chunk = 10;                    /* set loop iteration chunk size */
-
-/*** Spawn a parallel region explicitly scoping all variables ***/
-#pragma omp parallel shared(a,b,c,nthreads,chunk) private(tid,i,j,k)
-  {
-  tid = omp_get_thread_num();
-  if (tid == 0)
-    {
-    nthreads = omp_get_num_threads();
-    printf("Starting matrix multiple example with %d threads\n",nthreads);
-    printf("Initializing matrices...\n");
-    }
-  /*** Initialize matrices ***/
-  #pragma omp for schedule (static, chunk) 
-  for (i=0; i<NRA; i++)
-    for (j=0; j<NCA; j++)
-      a[i][j]= i+j;
-  #pragma omp for schedule (static, chunk)
-  for (i=0; i<NCA; i++)
-    for (j=0; j<NCB; j++)
-      b[i][j]= i*j;
-  #pragma omp for schedule (static, chunk)
-  for (i=0; i<NRA; i++)
-    for (j=0; j<NCB; j++)
-      c[i][j]= 0;
-
-  /*** Do matrix multiply sharing iterations on outer loop ***/
-  /*** Display who does which iterations for demonstration purposes ***/
-  printf("Thread %d starting matrix multiply...\n",tid);
-  #pragma omp for schedule (static, chunk)
-  for (i=0; i<NRA; i++)    
-    {
-    printf("Thread=%d did row=%d\n",tid,i);
-    for(j=0; j<NCB; j++)       
-      for (k=0; k<NCA; k++)
-        c[i][j] += a[i][k] * b[k][j];
-    }
-  }   /*** End of parallel region ***/
-
-/*** Print results ***/
-printf("******************************************************\n");
-printf("Result Matrix:\n");
-for (i=0; i<NRA; i++)
-  {
-  for (j=0; j<NCB; j++) 
-    printf("%6.2f   ", c[i][j]);
-  printf("\n"); 
-  }
-printf("******************************************************\n");
-printf ("Done.\n");
-
-return 0;  
-}
+/******************************************************************************
+* FILE: omp_mm.c * AUTHOR: Blaise Barney * LAST REVISED: 06/28/05
+******************************************************************************/
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "dgemm.h"
+
+// -----------------------------------------------------------------------
+// * The matrix multiply example with the dimensions given at run time,  *
+// * heap matrices and the blocked Dgemm of dgemm.c instead of the naive *
+// * loop; the result is printed only if it has at most 10 columns and   *
+// * 20 rows.  Usage: ./mmOMP [NRA NCA NCB] (default 8 10 5)             *
+// -----------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+    int nra = 8, nca = 10, ncb = 5, nthreads, i, j;
+    double *a, *b, *c, start, sec;
+
+    if (argc == 4) {
+        nra = atoi(argv[1]);
+        nca = atoi(argv[2]);
+        ncb = atoi(argv[3]);
+    }
+    if ((argc != 1 && argc != 4) || nra <= 0 || nca <= 0 || ncb <= 0) {
+        printf("Usage: ./mmOMP [NRA NCA NCB]\n");
+        exit(1);
+    }
+    nthreads = omp_get_max_threads();
+    printf("Starting matrix multiple example with %d threads\n", nthreads);
+    printf("Initializing matrices...\n");
+
+    a = MatAlloc(nra, nca);            /* matrix A to be multiplied */
+    b = MatAlloc(nca, ncb);            /* matrix B to be multiplied */
+    c = MatAlloc(nra, ncb);            /* result matrix C, zeroed   */
+    if (!a || !b || !c) {
+        printf("out of memory\n");
+        exit(1);
+    }
+#pragma omp parallel for private(j)
+    for (i=0; i<nra; i++)
+        for (j=0; j<nca; j++)
+            a[(size_t)i*nca + j] = i+j;
+#pragma omp parallel for private(j)
+    for (i=0; i<nca; i++)
+        for (j=0; j<ncb; j++)
+            b[(size_t)i*ncb + j] = i*j;
+
+    start = omp_get_wtime();
+    Dgemm(nra, ncb, nca, a, nca, b, ncb, c, ncb, nthreads);
+    sec = omp_get_wtime() - start;
+
+    if (nra <= 20 && ncb <= 10) {
+        printf("******************************************************\n");
+        printf("Result Matrix:\n");
+        for (i=0; i<nra; i++) {
+            for (j=0; j<ncb; j++)
+                printf("%6.2f   ", c[(size_t)i*ncb + j]);
+            printf("\n");
+        }
+        printf("******************************************************\n");
+    }
+    printf("%d x %d x %d in %.4f sec, %.2f GFLOPS\n", nra, nca, ncb, sec,
+           2.0 * nra * nca * ncb / sec / 1e9);
+    printf ("Done.\n");
+
+    MatFree(a);
+    MatFree(b);
+    MatFree(c);
+    return 0;
+}
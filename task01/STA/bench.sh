@@ -0,0 +1,179 @@
+#!/bin/sh
+# Benchmark and regression runner for 'sflprepc'.
+#
+# Runs the preprocessor over every '*.dimacs' file of a corpus directory for
+# each of the given thread counts (only with '--portfolio' among the options,
+# otherwise once), checks the produced formula against the golden checksums
+# in 'bench/golden', which are kept per instance and option string, and
+# records wall clock time, million propagations per second and peak resident
+# set size (taken from the JSON profile written by '--profile').  The results are compared against a
+# saved baseline and a run fails if it is slower by more than the given
+# threshold.
+
+die () {
+  echo "*** bench.sh: $*" 1>&2
+  exit 1
+}
+
+usage () {
+cat <<EOF
+usage: bench.sh [ <option> ... ]
+
+  -h               print this command line option summary
+  -c <dir>         corpus directory (default '.')
+  -t "<n> ..."     thread counts of '--portfolio' (default "1 2 4")
+  -r <percent>     allowed slow down against baseline (default 10)
+  -m <seconds>     ignore slow downs of runs faster than this (default 0.1)
+  -b <file>        baseline file (default 'bench/baseline')
+  -g <file>        golden checksums (default 'bench/golden')
+  -x <binary>      preprocessor binary (default './main')
+  -o "<options>"   additional options passed to the preprocessor
+  -s               save results as new baseline
+  -u               update golden checksums instead of checking them
+EOF
+}
+
+corpus=.
+threads="1 2 4"
+threshold=10
+minimum=0.1
+baseline=bench/baseline
+golden=bench/golden
+binary=./main
+options=""
+save=no
+update=no
+
+while [ $# -gt 0 ]
+do
+  case $1 in
+    -h) usage; exit 0;;
+    -c) shift; corpus="$1";;
+    -t) shift; threads="$1";;
+    -r) shift; threshold="$1";;
+    -m) shift; minimum="$1";;
+    -b) shift; baseline="$1";;
+    -g) shift; golden="$1";;
+    -x) shift; binary="$1";;
+    -o) shift; options="$1";;
+    -s) save=yes;;
+    -u) update=yes;;
+    *) die "invalid option '$1' (try '-h')";;
+  esac
+  shift
+done
+
+[ -x "$binary" ] || die "can not find executable '$binary'"
+[ -d "$corpus" ] || die "can not find corpus directory '$corpus'"
+
+# without '--portfolio' the preprocessor runs a single thread
+case " $options " in
+  *" --portfolio "*) portfolio=yes;;
+  *) portfolio=no; threads=1;;
+esac
+
+# golden checksums are kept per instance and option string
+tag=`echo $options | tr ' ' ','`
+
+tmp=/tmp/sflprepc-bench-$$
+mkdir -p $tmp || die "can not create '$tmp'"
+trap "rm -rf $tmp" 0 1 2 15
+
+results=$tmp/results
+: > $results
+[ $update = yes ] && : > $tmp/golden
+
+# extract a numeric field from the line based JSON profile
+field () {
+  sed -n -e "s/^  \"$1\": \([0-9.]*\),*$/\1/p" $2
+}
+
+failed=0
+for cnf in $corpus/*.dimacs
+do
+  [ -f "$cnf" ] || die "no '*.dimacs' files in '$corpus'"
+  name=`basename $cnf .dimacs`
+  key=$name${tag:+:$tag}
+  for t in $threads
+  do
+    out=$tmp/$name.out
+    json=$tmp/$name.json
+    par=""
+    [ $portfolio = yes ] && par="-p $t"
+    if ! $binary $par $options --profile=$json $cnf $out 2>$tmp/$name.err
+    then
+      tail -5 $tmp/$name.err 1>&2
+      die "'$binary' failed on '$cnf'"
+    fi
+    sum=`md5sum < $out | cut -d ' ' -f 1`
+    if [ $update = yes ]
+    then
+      awk -v key="$key" '$1 == key { found = 1 } END { exit !found }' \
+        $tmp/golden || echo "$key $sum" >> $tmp/golden
+      status=updated
+    else
+      expected=`awk -v key="$key" '$1 == key { print $2 }' $golden 2>/dev/null`
+      if [ -z "$expected" ]
+      then
+        status=unknown
+      elif [ "$expected" = "$sum" ]
+      then
+        status=ok
+      else
+        status=MISMATCH
+        failed=1
+      fi
+    fi
+    wall=`field wall $json`
+    props=`field propagations $json`
+    rss=`field max_rss_kb $json`
+    mpps=`echo "$props $wall" | awk '{ printf "%.2f", ($2 > 0 ? $1 / $2 / 1e6 : 0) }'`
+    echo "$name $t $wall $mpps $rss $status" >> $results
+  done
+done
+
+if [ $update = yes ]
+then
+  # keep the checksums of other option strings
+  [ -f $golden ] && \
+    awk 'NR == FNR { new[$1] = 1; next } !($1 in new)' $tmp/golden $golden \
+      > $tmp/kept && cat $tmp/kept >> $tmp/golden
+  cp $tmp/golden $golden && echo "updated '$golden'"
+fi
+
+awk -v baseline="$baseline" -v threshold="$threshold" -v minimum="$minimum" '
+BEGIN {
+  while ((getline line < baseline) > 0) {
+    split (line, f, " ")
+    base[f[1] " " f[2]] = f[3]
+  }
+  printf "%-24s %7s %10s %10s %10s %10s %9s %s\n",
+    "instance", "threads", "wall", "base", "change", "Mprops/s", "rss[kb]", "output"
+}
+{
+  key = $1 " " $2
+  change = "-"
+  if (key in base && base[key] > 0) {
+    delta = 100 * ($3 - base[key]) / base[key]
+    change = sprintf ("%+.1f%%", delta)
+    if (delta > threshold && $3 >= minimum) { change = change "!"; regressions++ }
+  }
+  printf "%-24s %7d %10.3f %10s %10s %10.2f %9d %s\n",
+    $1, $2, $3, (key in base ? sprintf ("%.3f", base[key]) : "-"),
+    change, $4, $5, $6
+}
+END {
+  if (regressions) {
+    printf "%d regressions above %s%%\n", regressions, threshold
+    exit 1
+  }
+}' $results || failed=1
+
+if [ $save = yes ]
+then
+  cut -d ' ' -f 1-5 $results > $baseline
+  echo "saved baseline '$baseline'"
+fi
+
+[ $failed = 0 ] || die "benchmark failed"
+exit 0
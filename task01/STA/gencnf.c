@@ -0,0 +1,365 @@
+/* Generator of synthetic CNF benchmarks in DIMACS format.
+ *
+ * The following parameterized families are supported:
+ *
+ *   random <vars> <ratio> [<k>]   uniform random k-SAT (default k = 3)
+ *                                 with 'ratio * vars' clauses
+ *
+ *   php <holes>                   pigeon hole principle with 'holes + 1'
+ *                                 pigeons (unsatisfiable)
+ *
+ *   pipe <width> <depth>          pipeline like structured instance: a
+ *                                 miter of two copies of a random circuit
+ *                                 of 'depth' stages of 'width' AND, OR and
+ *                                 XOR gates each (unsatisfiable)
+ *
+ * The instance is written to '<stdout>' or to the file given with '-o', so
+ * it can be piped directly into 'sflprepc' without touching the disk:
+ *
+ *   ./gencnf pipe 1000 100 | ./main -p 4 - out.cnf
+ *
+ * The random number generator is our own 64 bit xorshift generator, such
+ * that the same seed ('-s') always gives the same instance on every
+ * platform.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <assert.h>
+
+static FILE * output;
+static unsigned long long state;
+static long long clauses;	/* number of clauses generated */
+static int printing = 1;	/* zero while only counting clauses */
+
+    static void
+die (const char * msg, ...)
+{
+    va_list ap;
+    fputs ("*** gencnf: ", stderr);
+    va_start (ap, msg);
+    vfprintf (stderr, msg, ap);
+    va_end (ap);
+    fputc ('\n', stderr);
+    exit (1);
+}
+
+    static void
+seed (unsigned long long s)
+{
+    /* scramble with 'splitmix64' since 'state' must not be zero */
+    s += 0x9e3779b97f4a7c15ull;
+    s = (s ^ (s >> 30)) * 0xbf58476d1ce4e5b9ull;
+    s = (s ^ (s >> 27)) * 0x94d049bb133111ebull;
+    state = s ^ (s >> 31);
+    if (!state)
+        state = 1;
+}
+
+    static unsigned long long
+next (void)
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ull;
+}
+
+/* Uniformly pick a number in the range '0..n-1'.
+*/
+    static unsigned
+pick (unsigned n)
+{
+    assert (n > 0);
+    return (unsigned) ((next () >> 32) * (unsigned long long) n >> 32);
+}
+
+/* Printing with 'fprintf' dominates the run time for large instances,
+ * thus integers are converted by hand.
+ */
+    static void
+lit (int l)
+{
+    char buffer[16], * p = buffer + sizeof buffer;
+    unsigned u = l < 0 ? -(unsigned) l : (unsigned) l;
+    if (!printing)
+        return;
+    *--p = ' ';
+    do { *--p = '0' + u % 10; } while ((u /= 10));
+    if (l < 0)
+        *--p = '-';
+    fwrite (p, buffer + sizeof buffer - p, 1, output);
+}
+
+    static void
+eoc (void)
+{
+    clauses++;
+    if (printing)
+        fputs ("0\n", output);
+}
+
+    static void
+header (int vars, long long n)
+{
+    if (n > 0x7fffffff)
+        die ("too many clauses %lld", n);
+    fprintf (output, "p cnf %d %lld\n", vars, n);
+}
+
+    static void
+random_ksat (int vars, double ratio, int k)
+{
+    long long i, n = (long long) (ratio * vars + 0.5);
+    int * clause, j, l, v;
+
+    if (k < 1 || k > vars)
+        die ("invalid clause length %d", k);
+
+    header (vars, n);
+    clause = malloc (k * sizeof *clause);
+    for (i = 0; i < n; i++)
+    {
+        for (j = 0; j < k; j++)
+        {
+DRAW_VARIABLE_AGAIN:
+            v = 1 + pick (vars);
+            for (l = 0; l < j; l++)
+                if (clause[l] == v)
+                    goto DRAW_VARIABLE_AGAIN;
+            clause[j] = v;
+        }
+        for (j = 0; j < k; j++)
+            lit ((next () >> 63) ? -clause[j] : clause[j]);
+        eoc ();
+    }
+    free (clause);
+}
+
+/* Variable 'p * holes + h + 1' means pigeon 'p' sits in hole 'h'.
+*/
+    static void
+php (int holes)
+{
+    int pigeons = holes + 1, p, q, h;
+    long long n = pigeons + (long long) holes * pigeons * holes / 2;
+
+    header (pigeons * holes, n);
+    for (p = 0; p < pigeons; p++)
+    {
+        for (h = 0; h < holes; h++)
+            lit (p * holes + h + 1);
+        eoc ();
+    }
+    for (h = 0; h < holes; h++)
+        for (p = 0; p < pigeons; p++)
+            for (q = p + 1; q < pigeons; q++)
+            {
+                lit (-(p * holes + h + 1));
+                lit (-(q * holes + h + 1));
+                eoc ();
+            }
+}
+
+/* Tseitin encodings of 'o = a & b', 'o = a | b' and 'o = a ^ b'.
+*/
+    static void
+and_gate (int o, int a, int b)
+{
+    lit (-o); lit (a); eoc ();
+    lit (-o); lit (b); eoc ();
+    lit (o); lit (-a); lit (-b); eoc ();
+}
+
+    static void
+or_gate (int o, int a, int b)
+{
+    and_gate (-o, -a, -b);
+}
+
+    static void
+xor_gate (int o, int a, int b)
+{
+    lit (-o); lit (a); lit (b); eoc ();
+    lit (-o); lit (-a); lit (-b); eoc ();
+    lit (o); lit (-a); lit (b); eoc ();
+    lit (o); lit (a); lit (-b); eoc ();
+}
+
+/* The two copies of the circuit share the 'width' inputs '1..width'.  The
+ * gates of copy 'c' in stage 's' use the variables following the inputs.
+ * Every gate reads the gate in the same column of the previous stage and
+ * one randomly chosen gate close by, which gives the local structure
+ * typical of pipelined hardware.  Both copies are built from the same
+ * random choices.  Finally the outputs are compared pairwise with XOR
+ * gates and at least one of them is required to differ.  Returns the
+ * number of variables.
+ */
+    static int
+miter (int width, int depth)
+{
+    int s, c, j, o, a, b, op, span, vars, * prev[2], * cur[2], * tmp;
+    unsigned long long saved = state;
+
+    span = width < 8 ? width : 8;
+    vars = width;
+    for (c = 0; c < 2; c++)
+    {
+        prev[c] = malloc (width * sizeof (int));
+        cur[c] = malloc (width * sizeof (int));
+        for (j = 0; j < width; j++)
+            prev[c][j] = j + 1;
+    }
+
+    for (s = 0; s < depth; s++)
+    {
+        for (j = 0; j < width; j++)
+        {
+            op = pick (3);
+            b = (j + 1 + pick (span)) % width;
+            for (c = 0; c < 2; c++)
+            {
+                o = cur[c][j] = ++vars;
+                a = prev[c][j];
+                if (op == 0)
+                    and_gate (o, a, prev[c][b]);
+                else if (op == 1)
+                    or_gate (o, a, prev[c][b]);
+                else
+                    xor_gate (o, a, prev[c][b]);
+            }
+        }
+        for (c = 0; c < 2; c++)
+        {
+            tmp = prev[c];
+            prev[c] = cur[c];
+            cur[c] = tmp;
+        }
+    }
+
+    for (j = 0; j < width; j++)
+        xor_gate (++vars, prev[0][j], prev[1][j]);
+    for (j = 0; j < width; j++)
+        lit (vars - width + 1 + j);
+    eoc ();
+
+    for (c = 0; c < 2; c++)
+    {
+        free (prev[c]);
+        free (cur[c]);
+    }
+    state = saved;
+    return vars;
+}
+
+/* The number of clauses depends on the random gate types, thus the miter
+ * is generated twice with the same seed, first only counting clauses.
+ */
+    static void
+pipeline (int width, int depth)
+{
+    int vars;
+    if (width < 2)
+        die ("width %d too small", width);
+    printing = 0;
+    clauses = 0;
+    vars = miter (width, depth);
+    header (vars, clauses);
+    printing = 1;
+    miter (width, depth);
+}
+
+    static void
+usage (void)
+{
+    printf (
+"usage: gencnf [ <option> ... ] <family> <argument> ...\n"
+"\n"
+"where <option> is one of the following\n"
+"\n"
+"  -h               print this command line option summary\n"
+"  -s <seed>        seed of random number generator (default 0)\n"
+"  -o <output>      write instance to <output> instead of <stdout>\n"
+"\n"
+"and <family> <argument> ... is one of the following\n"
+"\n"
+"  random <vars> <ratio> [<k>]   random k-SAT (default k = 3)\n"
+"  php <holes>                   pigeon hole principle\n"
+"  pipe <width> <depth>          miter of pipeline like circuits\n");
+}
+
+    int
+main (int argc, char ** argv)
+{
+    const char * output_name = 0, * family = 0;
+    const char * args[3] = { 0, 0, 0 };
+    int i, nargs = 0;
+
+    output = stdout;
+    seed (0);
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp (argv[i], "-h"))
+        {
+            usage ();
+            exit (0);
+        }
+        else if (!strcmp (argv[i], "-s"))
+        {
+            if (++i == argc)
+                die ("argument to '-s' missing");
+            seed (strtoull (argv[i], 0, 10));
+        }
+        else if (!strcmp (argv[i], "-o"))
+        {
+            if (++i == argc)
+                die ("argument to '-o' missing");
+            output_name = argv[i];
+        }
+        else if (argv[i][0] == '-')
+            die ("invalid option '%s' (try '-h')", argv[i]);
+        else if (!family)
+            family = argv[i];
+        else if (nargs < 3)
+            args[nargs++] = argv[i];
+        else
+            die ("too many arguments (try '-h')");
+    }
+
+    if (!family)
+        die ("family missing (try '-h')");
+
+    if (output_name && !(output = fopen (output_name, "w")))
+        die ("can not write '%s'", output_name);
+
+    if (!strcmp (family, "random"))
+    {
+        if (nargs < 2)
+            die ("expected 'random <vars> <ratio> [<k>]'");
+        random_ksat (atoi (args[0]), atof (args[1]),
+                nargs > 2 ? atoi (args[2]) : 3);
+    }
+    else if (!strcmp (family, "php"))
+    {
+        if (nargs != 1 || atoi (args[0]) < 1)
+            die ("expected 'php <holes>'");
+        php (atoi (args[0]));
+    }
+    else if (!strcmp (family, "pipe"))
+    {
+        if (nargs != 2)
+            die ("expected 'pipe <width> <depth>'");
+        pipeline (atoi (args[0]), atoi (args[1]));
+    }
+    else
+        die ("unknown family '%s' (try '-h')", family);
+
+    if (output_name)
+        fclose (output);
+    else
+        fflush (output);
+
+    return 0;
+}
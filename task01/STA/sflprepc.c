@@ -15,12 +15,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <stdarg.h>
 #include <assert.h>
 #include <sys/time.h>
 #include <ctype.h>
 #include <sys/resource.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <omp.h>
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc ()
+#else
+#define CYCLES() 0ull
+#endif
 
 /* By setting this to '1' you can enable 'logging'.
 */
@@ -37,14 +50,21 @@ static FILE * input, * output;
 static const char * input_name, * output_name;
 static int * stack, * top_of_stack, * end_of_stack;
 
-static int inconsistent;/* found empty clause */
+static volatile int inconsistent;/* found empty clause */
 static int m;		/* number of variables 'm' in 'p cnf m n' */
 static int n;		/* number of clauses 'n' in 'p cnf m n' */
 static int ** clauses;	/* 'n' clauses (0..n-1) zero terminated */
 
+/* All clauses are stored consecutively in one memory block, the 'arena',
+ * in the order of their indices, which avoids the overhead of allocating
+ * every clause separately.  Thus clause 'i' ends right before 'clauses[i+1]'.
+ */
+static int * arena;
+static size_t arena_size, arena_capacity;	/* in number of 'int's */
+
 /* Variables are signed integers in the range '1..m'.
 */
-static int * assignment;/* for 'var=1..m' <0 false, >0 true, =0 unassigned */
+static __thread int * assignment;/* for 'var=1..m' <0 false, >0 true, =0 unassigned */
 
 /* Signed variables are literals.  Negative values denote negated variables.
  * The literals are in the range '-m..m' where '0' is of course excluded.
@@ -55,14 +75,124 @@ static int * counts;	/* for 'lit=-m...m' number occurrences */
 static int ** lit2occs;	/* for 'lit=-m..m' clause indices -1 terminated */
 static int * occs;	/* one memory block for all clauses indices */
 
-/* The next two lines contain statistics.
+/* The next two lines contain statistics (per thread, see '--portfolio').
 */
-static int units, rounds, decisions;
-static long long propagations;
+static __thread int units, rounds, decisions;
+static __thread long long propagations;
+
+int threadNum = 1;
+
+/* Probing budgets.  A negative limit means unlimited.  If one of them is
+ * exhausted 'process' stops before the next probe, also inside the probing
+ * tree, backtracks to the top level and the simplified formula found so far
+ * is printed as usual ('anytime' output).
+ * The time limit is measured in wall clock time from the start of 'main'.
+ * In '--portfolio' the propagations of all threads count against the
+ * propagation limit: before every probe a thread adds the propagations
+ * since its last probe to the shared 'spent'.
+ */
+static double time_limit = -1, start_time;
+static long long propagation_limit = -1;
+static long long spent;		/* propagations of all threads */
+static __thread long long counted;	/* of this thread, in 'spent' */
+static int round_limit = -1;
+static volatile int limited;	/* budget exhausted */
+
+/* The order in which variables are probed in 'process'.  With 'occs' the
+ * variables with most occurrences are probed first, since their
+ * propagation touches most clauses and they are more likely to fail.  With
+ * 'random' the variables and their first phase are shuffled using 'seed'.
+ */
+enum { NATURAL_ORDER, OCCS_ORDER, RANDOM_ORDER, ORDERS };
+static const char * order_names[ORDERS] = { "natural", "occs", "random" };
+static int order = NATURAL_ORDER;
+static unsigned long long seed;
+static __thread int * schedule;	/* probe order: 'm' signed literals */
+
+/* With '--portfolio' every one of the '-p' threads runs 'process' on its
+ * own copy of the assignment, trail and counters with a different probing
+ * order: thread '0' uses 'order', the next two the remaining orders and
+ * all further ones 'random' with different seeds.  The clauses and
+ * occurrence lists are shared read only.  Units found on the top level
+ * are published in the shared 'queue', which is lock-free: a variable is
+ * claimed by a compare and swap on 'owner', then a slot is reserved by an
+ * atomic increment of 'queued' and finally the literal is stored, thus a
+ * zero slot is not written yet.  Each thread imports the queue before
+ * every probe.  The first thread completing a round without a new unit,
+ * neither found nor imported, has reached the fixpoint and stops all
+ * others.  Every unit found by another thread is already implied by this
+ * fixpoint, since a failed literal stays failed under more assignments.
+ */
+static int portfolio;
+static int * queue, * owner;
+static int queued;
+static volatile int stop;	/* some thread reached the fixpoint */
+static int winner = -1;
+static int others_decisions;	/* statistics of threads other than '0' */
+static long long others_propagations;
+static __thread int worker_id, imported, exported;
+
+/* Profiling is enabled with '--profile=<file>'.  Then wall clock time
+ * (and with '--cycles' also time stamp counter cycles) is accumulated for
+ * each phase below, the time of every probing round is saved and the
+ * lengths of the occurrence lists visited in 'bcp' are collected in a
+ * histogram with logarithmic buckets: bucket 'i > 0' counts lists of
+ * length '2^(i-1)..2^i-1' and bucket '0' empty lists.  If profiling is
+ * disabled the overhead is a single branch per phase.  In '--portfolio'
+ * mode only the profile of thread '0' is written.
+ */
+enum { PARSE, CONNECT, LOAD, PROBE, BCP, BACKTRACK, PRINT, PHASES };
+
+static const char * phase_names[PHASES] =
+{ "parse", "connect", "load", "probe", "bcp", "backtrack", "print" };
+
+static __thread struct phase
+{
+    double start, time;
+    unsigned long long start_cycles, cycles;
+    long long calls;
+} phases[PHASES];
+
+#define HISTO 32
+static __thread long long histo[HISTO];
+
+static int profiling, cycles;
+static const char * profile_name;
+static __thread double * round_times;	/* 'rounds' entries */
+
+/* A snapshot is a binary image of the parsed and connected formula, which
+ * is written with '--snapshot=<file>' and recognized by its magic header
+ * if given as input.  It is mapped into memory and only the 'clauses' and
+ * 'lit2occs' pointer tables have to be rebuilt from the offsets stored in
+ * the file, which avoids parsing and connecting the formula again.  The
+ * header is followed by the following 'int' arrays:
+ *
+ *   offsets[n]          start of clause 'i' in 'arena'
+ *   arena[lits + n]     all clauses, zero terminated
+ *   nonfalse[n]         initial 'nonfalse' counters (clause sizes)
+ *   counts[2*m+1]       occurrence counts for 'lit=-m..m'
+ *   occ_offsets[2*m+1]  start of 'lit2occs[lit]' in 'occs'
+ *   occs[lits + 2*m]    occurrence lists, -1 terminated
+ *
+ * The mapping is private, thus 'nonfalse' is copied on write.
+ */
+#define SNAPSHOT_MAGIC "SFLPSNAP"
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_ORDER 0x01020304	/* reads differently on other endianness */
+
+struct snapshot
+{
+    char magic[8];
+    int order, version, int_size, m, n, lits;
+};
+
+static const char * snapshot_name;	/* write snapshot to this file */
+static void * mapped;			/* mapped snapshot if non zero */
+static size_t mapped_size;
 
 /*---------------------------------------------------------*\
- * NOTE: in the threaded version each worker thread should *
- * probably have a copy of the following static variables. *
+ * NOTE: in '--portfolio' mode each worker thread has its  *
+ * own copy of the following thread local variables.       *
  *---------------------------------------------------------*/
 
 /* This counts for the i'th clause 'clauses[i]' the number of literals that
@@ -72,7 +202,16 @@ static long long propagations;
  * be inconsisten, e.g. unsatisfiable.  If the counter becomes 1, then
  * the remaining literal is assigned to true.
  */
-static int * nonfalse;
+static __thread int * nonfalse;
+
+/* With '--compact' the 'nonfalse' counters are kept in the smallest of
+ * 8 or 16 bits which can hold the maximum clause size instead, and only
+ * fall back to 'int' for clauses with 2^16 or more literals.  The counters
+ * are then accessed through 'DEC' and 'inc' which dispatch on 'width'.
+ */
+static int compact, width = sizeof (int);
+static __thread unsigned char * nonfalse8;
+static __thread unsigned short * nonfalse16;
 
 /* The trail is a stack that contains all the literals assigned to true:
  *
@@ -100,7 +239,36 @@ static int * nonfalse;
  * variables that need to be unassigned during backtracking is saved in the
  * 'decision' pointer, which if no assumption is made.
  */
-static int * trail, * next_to_propagate, *top_of_trail, * decision;
+static __thread int * trail, * next_to_propagate, *top_of_trail, * decision;
+
+/* With '--tree' the literals are probed along a spanning forest of the
+ * binary implication graph.  A child 'c' of 'p' in this forest implies its
+ * parent through a binary clause '-c | p'.  Therefore probing 'c' on top
+ * of the trail of 'p' produces a conflict iff probing 'c' alone does, and
+ * the propagation of 'p' is shared among all its descendants.  The forest
+ * is stored in DFS preorder with the depth of each node.  See 'forest'.
+ */
+static int tree;
+static int * tree_lits, * tree_depths, ntree;
+static signed char * tree_fixed;
+static int * path;
+static int ** control, level;
+
+/* With '--hbr' a literal 'l' implied during probing through a clause with
+ * more than two literals yields the hyper binary resolvent '-d | l', where
+ * 'd' is the decision of the current level, which implies all the false
+ * literals of the clause.  These learned binary clauses are kept in
+ * 'learned' as pairs and as implications in 'impls', such that 'impls[x]'
+ * contains all 'y' with a learned clause '-x | y'.  The implications are
+ * propagated by 'bcp' before the occurrences of a literal are visited,
+ * which usually assigns the literal cheaper in later probes.  Before
+ * printing, learned clauses implied transitively by other binary clauses
+ * are removed.  Removed clauses are zeroed in both 'learned' and 'impls'.
+ */
+static int hbr;
+static int ** impls, * nimpls, * simpls;
+static int * learned, nlearned, slearned;	/* 'nlearned' pairs */
+static int hbrs, reduced;
 
 #define NEW(p,n) do { (p) = calloc ((n), sizeof (*(p))); } while (0)
 
@@ -126,6 +294,62 @@ seconds ()
     return res;
 }
 
+    static double
+wall (void)
+{
+    struct timespec ts;
+    if (clock_gettime (CLOCK_MONOTONIC, &ts)) return 0;
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+    static void
+enter (int phase)
+{
+    struct phase * p;
+    if (!profiling)
+        return;
+    p = phases + phase;
+    p->start = wall ();
+    if (cycles)
+        p->start_cycles = CYCLES ();
+}
+
+    static double
+leave (int phase)
+{
+    struct phase * p;
+    double delta;
+    if (!profiling)
+        return 0;
+    p = phases + phase;
+    if (cycles)
+        p->cycles += CYCLES () - p->start_cycles;
+    delta = wall () - p->start;
+    p->time += delta;
+    p->calls++;
+    return delta;
+}
+
+    static void
+visited (long len)
+{
+    int i = 0;
+    while (len && i < HISTO - 1)
+    {
+        len >>= 1;
+        i++;
+    }
+    histo[i]++;
+}
+
+    static long
+max_rss (void)
+{
+    struct rusage u;
+    if (getrusage (RUSAGE_SELF, &u)) return 0;
+    return u.ru_maxrss;
+}
+
     static void
 msg (const char * msg, ...)
 {
@@ -187,7 +411,8 @@ empty (void)
     static void
 parse (void)
 {
-    int ch, c, sign, lit, * clause, i, l;
+    int ch, c, sign, lit, * starts, i, l;
+    enter (PARSE);
     msg ("parsing %s", input_name);
     line = 1;
     while ((ch = nextch ()) == 'c')
@@ -233,7 +458,7 @@ parse (void)
     NEW (trail, m);
     NEW (assignment, m + 1);
     NEW (clauses, n);
-    NEW (nonfalse, n);
+    NEW (starts, n);		/* clause offsets while 'arena' grows */
 
     next_to_propagate = top_of_trail = trail;
     c = 0;
@@ -254,6 +479,13 @@ parse (void)
 
             assert (c == n);
 
+            arena = realloc (arena, (arena_size + 1) * sizeof *arena);
+            arena_capacity = arena_size + 1;
+            for (i = 0; i < n; i++)
+                clauses[i] = arena + starts[i];
+            free (starts);
+
+            leave (PARSE);
             return;
         }
 
@@ -301,31 +533,96 @@ parse (void)
         else
         {
             l = top_of_stack - stack;
-            NEW (clause, l + 1);
-            for (i = 0; i < l; i++)
-                clause[i] = stack[i];
-            clause[i] = 0;
-            clauses[c++] = clause;
+            if (arena_size + l + 1 > arena_capacity)
+            {
+                while (arena_size + l + 1 > arena_capacity)
+                    arena_capacity = arena_capacity ? 2 * arena_capacity : 1024;
+                arena = realloc (arena, arena_capacity * sizeof *arena);
+                if (!arena)
+                    die ("out of memory allocating clause arena");
+            }
+            starts[c++] = arena_size;
+            memcpy (arena + arena_size, stack, l * sizeof *stack);
+            arena_size += l;
+            arena[arena_size++] = 0;
             top_of_stack = stack;
         }
     }
 }
 
+    static int
+length (int i)
+{
+    int * end = (i + 1 < n) ? clauses[i + 1] : arena + arena_size;
+    return end - clauses[i] - 1;
+}
+
+/* Allocate and initialize the 'nonfalse' counters of the current thread to
+ * the clause sizes.
+ */
+    static void
+init_counters (void)
+{
+    int i;
+    if (width == 1)
+    {
+        NEW (nonfalse8, n);
+        for (i = 0; i < n; i++)
+            nonfalse8[i] = length (i);
+    }
+    else if (width == 2)
+    {
+        NEW (nonfalse16, n);
+        for (i = 0; i < n; i++)
+            nonfalse16[i] = length (i);
+    }
+    else
+    {
+        NEW (nonfalse, n);
+        for (i = 0; i < n; i++)
+            nonfalse[i] = length (i);
+    }
+}
+
+/* Select the counter 'width' and initialize the counters.
+*/
+    static void
+counters (void)
+{
+    int i, max = 0, len;
+
+    for (i = 0; i < n; i++)
+        if ((len = length (i)) > max)
+            max = len;
+
+    if (compact && max < 256)
+        width = 1;
+    else if (compact && max < 65536)
+        width = 2;
+    else
+        width = sizeof (int);
+
+    init_counters ();
+
+    if (compact)
+        msg ("using %d bit counters for maximum clause size %d",
+                8 * width, max);
+}
+
     static void
 connect (void)
 {
     int i, var, lit, * p, * q, sign, count, lits;
 
+    enter (CONNECT);
     NEW (counts, 2 * m + 1);
     counts += m;			/* accessible as [-m,...,-1,0,1,..,m] */
 
     for (i = 0; i < n; i++)
-    {
         for (p = clauses[i]; (lit = *p); p++)
             counts[lit]++;
 
-        nonfalse[i] = p - clauses[i];
-    }
+    counters ();
 
     lits = 0;
     for (var = 1; var <= m; var++)
@@ -356,6 +653,7 @@ connect (void)
             lit2occs[lit] = q;
         }
 
+    leave (CONNECT);
     msg ("connected %d literals", lits);
 }
 
@@ -388,9 +686,13 @@ satisfied (int * clause)
 print (void)
 {
     int c = units, i, * p, lit, tmp;
+    enter (PRINT);
     for (i = 0; i < n; i++)
         if (!satisfied (clauses[i]))
             c++;
+    for (i = 0; i < nlearned; i++)
+        if (learned[2 * i] && !val (learned[2 * i]) && !val (learned[2 * i + 1]))
+            c++;
     fprintf (output, "p cnf %d %d\n", m, c);
     for (i = 0; i < n; i++)
         if (!satisfied (p = clauses[i]))
@@ -407,10 +709,14 @@ print (void)
             }
             fputs ("0\n", output);
         }
+    for (i = 0; i < nlearned; i++)
+        if (learned[2 * i] && !val (learned[2 * i]) && !val (learned[2 * i + 1]))
+            fprintf (output, "%d %d 0\n", learned[2 * i], learned[2 * i + 1]);
     for (lit = 1; lit <= m; lit++)
         if ((tmp = val (lit)))
             fprintf (output, "%d 0\n", (tmp < 0 ? -lit : lit));
     fflush (output);
+    leave (PRINT);
 }
 
     static void
@@ -446,49 +752,162 @@ unassign (int lit)
 inc (int lit)
 {
     int * p, clsidx;
-    for (p = lit2occs[lit]; (clsidx = *p) >= 0; p++)
-        nonfalse[clsidx]++;
+    if (width == 1)
+        for (p = lit2occs[lit]; (clsidx = *p) >= 0; p++)
+            nonfalse8[clsidx]++;
+    else if (width == 2)
+        for (p = lit2occs[lit]; (clsidx = *p) >= 0; p++)
+            nonfalse16[clsidx]++;
+    else
+        for (p = lit2occs[lit]; (clsidx = *p) >= 0; p++)
+            nonfalse[clsidx]++;
 }
 
+/* Decrement the 'nonfalse' counter of clause 'c' and save its new value
+ * in 'res'.  This is a macro, since it is on the hot path of 'bcp'.
+ */
+#define DEC(c,res) \
+do { \
+    if (width == 1) \
+    { \
+        assert (nonfalse8[c] > 0); \
+        (res) = --nonfalse8[c]; \
+    } \
+    else if (width == 2) \
+    { \
+        assert (nonfalse16[c] > 0); \
+        (res) = --nonfalse16[c]; \
+    } \
+    else \
+    { \
+        assert (nonfalse[c] > 0); \
+        (res) = --nonfalse[c]; \
+    } \
+} while (0)
+
     static void
-backtrack (void)
+undo (int * pos)
 {
     int lit;
-    assert (decision);
-    while (top_of_trail > decision)
+    while (top_of_trail > pos)
     {
         lit = *--top_of_trail;
         unassign (lit);
         if (top_of_trail < next_to_propagate)
             inc (-lit);
     }
-    decision = 0;
     next_to_propagate = top_of_trail;
 }
 
+    static void
+backtrack (void)
+{
+    assert (decision);
+    enter (BACKTRACK);
+    undo (decision);
+    decision = 0;
+    leave (BACKTRACK);
+}
+
+/* Tree based probing needs more than one decision level.  The trail
+ * position where decision level 'i + 1' starts is saved in 'control[i]',
+ * thus 'control[0] == decision' if 'level > 0'.  A level might be empty if
+ * its literal was already assigned when it was opened.
+ */
+    static void
+descend (int lit)
+{
+    assert (level < 2 * m);
+    if (!level)
+        decision = next_to_propagate;
+    control[level++] = next_to_propagate;
+    if (lit)
+    {
+        LOG (msg ("decide %d at level %d", lit, level));
+        decisions++;
+        assign (lit);
+    }
+}
+
+    static void
+ascend (int target)
+{
+    assert (target < level);
+    enter (BACKTRACK);
+    undo (control[target]);
+    level = target;
+    if (!level)
+        decision = 0;
+    leave (BACKTRACK);
+}
+
+    static void
+imply (int from, int to)
+{
+    if (nimpls[from] == simpls[from])
+    {
+        simpls[from] = simpls[from] ? 2 * simpls[from] : 2;
+        impls[from] = realloc (impls[from], simpls[from] * sizeof (int));
+    }
+    impls[from][nimpls[from]++] = to;
+}
+
+/* Learn the hyper binary resolvent '-d | lit' where 'd' is the decision
+ * of the current level.
+ */
+    static void
+hyper (int lit)
+{
+    int d = level ? *control[level - 1] : *decision;
+    assert (val (d) > 0);
+    if (nlearned == slearned)
+    {
+        slearned = slearned ? 2 * slearned : 16;
+        learned = realloc (learned, 2 * slearned * sizeof *learned);
+    }
+    learned[2 * nlearned] = -d;
+    learned[2 * nlearned + 1] = lit;
+    nlearned++;
+    imply (d, lit);
+    imply (-lit, -d);
+    hbrs++;
+    LOG (msg ("hyper binary resolvent %d %d", -d, lit));
+}
+
     static int
 bcp (void)
 {
-    int lit, * p, clsidx, failed, count, other, * q, tmp;
+    int lit, * p, clsidx, failed, count, other, * q, tmp, * end;
 
+    enter (BCP);
     failed = 0;
     while (!failed && next_to_propagate < top_of_trail)
     {
         lit = -*next_to_propagate++;
         LOG (msg ("propagate %d", -lit));
         propagations++;
+        if (hbr)
+        {
+            end = impls[-lit] + nimpls[-lit];
+            for (q = impls[-lit]; !failed && q < end; q++)
+            {
+                if (!(other = *q) || (tmp = val (other)) > 0)
+                    continue;
+                if (tmp < 0)
+                    failed = 1;
+                else
+                    assign (other);
+            }
+        }
 #pragma omp single
         {
             p = lit2occs[lit];
             while (*p >= 0)
             {
-#pragma omp task firstprivate(p) shared(nonfalse, clauses, failed)
+#pragma omp task firstprivate(p) shared(clauses, failed)
                 {
                     clsidx = *p;
-                    count = nonfalse[clsidx];
-                    assert (count > 0);
-                    count--;
-                    nonfalse[clsidx] = count;
+                    DEC (clsidx, count);
                     if (!count)
                     {
                         if (!failed)
@@ -510,23 +929,736 @@ FOUND_CONFLICTING_CLAUSE:
                         if (!other)
                             goto FOUND_CONFLICTING_CLAUSE;
                         if (tmp <= 0)
+                        {
                             /*    continue;*/
                             /*LOG (msg ("implying %d by clause %d", other, clsidx));*/
                             assign (other);
+                            if (hbr && decision && clauses[clsidx][2])
+                                hyper (other);
+                        }
                     }
                 }
                 p++;
             }
+            if (profiling)
+                visited (p - lit2occs[lit]);
         }
     }
 
+    leave (BCP);
     return !failed;
 }
 
+    static int
+exhausted (void)
+{
+    long long total = propagations;
+
+    if (stop || limited || inconsistent)
+        return 1;
+    if (portfolio && propagation_limit >= 0)
+    {
+        total = __sync_add_and_fetch (&spent, propagations - counted);
+        counted = propagations;
+    }
+    if (propagation_limit >= 0 && total >= propagation_limit)
+    {
+        msg ("propagation limit %lld reached in round %d",
+                propagation_limit, rounds + 1);
+        limited = 1;
+    }
+    else if (time_limit >= 0 && wall () - start_time >= time_limit)
+    {
+        msg ("time limit %.2f seconds reached in round %d",
+                time_limit, rounds + 1);
+        limited = 1;
+    }
+    return limited;
+}
+
+    static int
+cmp_occs (const void * p, const void * q)
+{
+    int a = *(const int *) p, b = *(const int *) q, res;
+    res = (counts[b] + counts[-b]) - (counts[a] + counts[-a]);
+    return res ? res : a - b;
+}
+
+/* Our own 64 bit xorshift generator, such that a seed gives the same
+ * random order on every platform (the same as in 'gencnf').
+ */
+    static unsigned long long
+next (unsigned long long * state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ull;
+}
+
+/* Fill 'schedule' with the variables to be probed in the order 'which'.
+ * The sign of each entry determines which phase of the variable is probed
+ * first.  For 'occs' this is the literal whose negation occurs most often,
+ * since assigning it shortens most clauses.
+ */
+    static void
+sched (int which, unsigned long long s)
+{
+    int var, i, j, lit;
+    unsigned long long state;
+
+    NEW (schedule, m);
+    for (var = 1; var <= m; var++)
+        schedule[var - 1] = var;
+
+    if (which == NATURAL_ORDER)
+        return;
+
+    if (which == RANDOM_ORDER)
+    {
+        /* scramble with 'splitmix64' since 'state' must not be zero */
+        state = s + 0x9e3779b97f4a7c15ull;
+        state = (state ^ (state >> 30)) * 0xbf58476d1ce4e5b9ull;
+        state = (state ^ (state >> 27)) * 0x94d049bb133111ebull;
+        state = (state ^ (state >> 31)) | 1;
+        for (i = m - 1; i >= 0; i--)
+        {
+            j = (next (&state) >> 32) * (unsigned long long) (i + 1) >> 32;
+            lit = schedule[j];
+            schedule[j] = schedule[i];
+            schedule[i] = (next (&state) >> 63) ? -lit : lit;
+        }
+        msg ("scheduled %d probes in random order with seed %llu", m, s);
+        return;
+    }
+
+    qsort (schedule, m, sizeof *schedule, cmp_occs);
+    for (i = 0; i < m; i++)
+    {
+        lit = schedule[i];
+        if (counts[lit] > counts[-lit])
+            schedule[i] = -lit;
+    }
+    msg ("scheduled %d probes by occurrences", m);
+}
+
+/* Build the probing forest for '--tree' from the binary clauses of the
+ * original formula.  The children of 'p' are all 'c' with a binary clause
+ * '-c | p', stored in 'kids[p]'.  Roots are taken in 'schedule' order,
+ * first literals which imply nothing through binary clauses, since those
+ * are the natural roots of the forest, then all the remaining ones.  The
+ * DFS uses the parse 'stack' for pairs of literal and depth and marks
+ * nodes when pushed, such that every subtree is contiguous in preorder.
+ */
+    static void
+forest (void)
+{
+    int i, j, lit, other, depth, pass, * clause, * bins, ** kids, * block, * p;
+    char * mark;
+    int nbins = 0, maxdepth = 0;
+
+    NEW (bins, 2 * m + 1);
+    bins += m;
+    for (i = 0; i < n; i++)
+    {
+        clause = clauses[i];
+        if (!clause[0] || !clause[1] || clause[2])
+            continue;
+        bins[clause[0]]++;
+        bins[clause[1]]++;
+        nbins++;
+    }
+
+    NEW (kids, 2 * m + 1);
+    kids += m;
+    NEW (block, 2 * nbins + 2 * m);
+    p = block;
+    for (lit = -m; lit <= m; lit++)
+    {
+        if (!lit)
+            continue;
+        p += bins[lit];
+        kids[lit] = p;
+        *p++ = 0;		/* zero sentinel */
+    }
+    for (i = 0; i < n; i++)
+    {
+        clause = clauses[i];
+        if (!clause[0] || !clause[1] || clause[2])
+            continue;
+        *--kids[clause[0]] = -clause[1];
+        *--kids[clause[1]] = -clause[0];
+    }
+
+    NEW (tree_lits, 2 * m);
+    NEW (tree_depths, 2 * m);
+    NEW (tree_fixed, 2 * m);
+    NEW (path, 2 * m);
+    NEW (control, 2 * m);
+    NEW (mark, 2 * m + 1);
+    mark += m;
+
+    for (pass = 0; pass < 2; pass++)
+        for (i = 0; i < 2 * m; i++)
+        {
+            lit = (i & 1) ? -schedule[i / 2] : schedule[i / 2];
+            if (mark[lit] || (!pass && bins[-lit]))
+                continue;
+            mark[lit] = 1;
+            push (lit);
+            push (0);
+            while (!empty ())
+            {
+                depth = *--top_of_stack;
+                lit = *--top_of_stack;
+                tree_lits[ntree] = lit;
+                tree_depths[ntree++] = depth;
+                if (depth > maxdepth)
+                    maxdepth = depth;
+                for (j = 0; (other = kids[lit][j]); j++)
+                {
+                    if (mark[other])
+                        continue;
+                    mark[other] = 1;
+                    push (other);
+                    push (depth + 1);
+                }
+            }
+        }
+    assert (ntree == 2 * m);
+
+    free (mark - m);
+    free (block);
+    free (kids - m);
+    free (bins - m);
+
+    msg ("probing forest over %d binary clauses with depth %d",
+            nbins, maxdepth);
+}
+
+    static void
+write_ints (FILE * file, const int * a, size_t count)
+{
+    if (fwrite (a, sizeof *a, count, file) != count)
+        die ("writing snapshot '%s' failed", snapshot_name);
+}
+
+    static void
+save (void)
+{
+    struct snapshot header;
+    int i, lit, * offsets;
+    FILE * file;
+
+    if (!(file = fopen (snapshot_name, "wb")))
+        die ("can not write snapshot '%s'", snapshot_name);
+
+    memset (&header, 0, sizeof header);
+    memcpy (header.magic, SNAPSHOT_MAGIC, sizeof header.magic);
+    header.order = SNAPSHOT_ORDER;
+    header.version = SNAPSHOT_VERSION;
+    header.int_size = sizeof (int);
+    header.m = m;
+    header.n = n;
+    header.lits = arena_size - n;
+    if (fwrite (&header, sizeof header, 1, file) != 1)
+        die ("writing snapshot '%s' failed", snapshot_name);
+
+    NEW (offsets, 2 * m + 1 > n ? 2 * m + 1 : n);
+    for (i = 0; i < n; i++)
+        offsets[i] = clauses[i] - arena;
+    write_ints (file, offsets, n);
+    write_ints (file, arena, arena_size);
+    for (i = 0; i < n; i++)
+        offsets[i] = length (i);
+    write_ints (file, offsets, n);
+    write_ints (file, counts - m, 2 * m + 1);
+    for (lit = -m; lit <= m; lit++)
+        offsets[lit + m] = lit ? lit2occs[lit] - occs : 0;
+    write_ints (file, offsets, 2 * m + 1);
+    write_ints (file, occs, header.lits + 2 * m);
+    free (offsets);
+
+    if (fclose (file))
+        die ("writing snapshot '%s' failed", snapshot_name);
+    msg ("wrote snapshot %s", snapshot_name);
+}
+
+/* Returns non zero if 'input' starts with the snapshot magic and rewinds
+ * it otherwise.  Snapshots are mapped, thus only regular files can be
+ * snapshots, and pipes are never read ahead, since they can not rewind.
+ */
+    static int
+is_snapshot (void)
+{
+    char magic[8];
+    struct stat st;
+    if (input == stdin || fstat (fileno (input), &st) || !S_ISREG (st.st_mode))
+        return 0;
+    if (fread (magic, sizeof magic, 1, input) == 1 &&
+            !memcmp (magic, SNAPSHOT_MAGIC, sizeof magic))
+        return 1;
+    rewind (input);
+    return 0;
+}
+
+    static void
+corrupted (void)
+{
+    die ("corrupted snapshot '%s'", input_name);
+}
+
+    static void
+load (void)
+{
+    struct snapshot * header;
+    int i, lit, sign, * p, * q, * offsets, * occ_offsets;
+    struct stat st;
+    size_t expected;
+    int fd;
+
+    enter (LOAD);
+    if ((fd = open (input_name, O_RDONLY)) < 0 || fstat (fd, &st))
+        die ("can not read snapshot '%s'", input_name);
+    mapped_size = st.st_size;
+    mapped = mmap (0, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (mapped == MAP_FAILED)
+        die ("can not map snapshot '%s'", input_name);
+
+    header = mapped;
+    if (mapped_size < sizeof *header)
+        corrupted ();
+    if (header->order != SNAPSHOT_ORDER)
+        die ("snapshot '%s' has a different byte order", input_name);
+    if (header->version != SNAPSHOT_VERSION ||
+            header->int_size != sizeof (int))
+        die ("incompatible snapshot '%s'", input_name);
+
+    m = header->m;
+    n = header->n;
+    if (m < 0 || n < 0 || header->lits < 0 ||
+            header->lits > INT_MAX - n || m > (INT_MAX - header->lits) / 2)
+        corrupted ();
+    expected = 3 * (size_t) n + 2 * (size_t) header->lits;
+    expected += 2 * (2 * (size_t) m + 1) + 2 * (size_t) m;
+    expected = sizeof *header + expected * sizeof (int);
+    if (mapped_size != expected)
+        corrupted ();
+
+    /* Every offset, literal and index is checked before it is used:
+     * clauses are increasing zero terminated ranges of the arena over
+     * literals of at most 'm' variables, and the occurrence lists are
+     * '-1' terminated ranges of clause indices.
+     */
+    p = (int *) (header + 1);
+    offsets = p;
+    p += n;
+    arena = p;
+    arena_size = header->lits + n;
+    for (i = 0; i < n; i++)
+        if (offsets[i] < 0 || offsets[i] >= arena_size ||
+                (i && offsets[i] <= offsets[i - 1]))
+            corrupted ();
+    for (i = 0; i < arena_size; i++)
+        if (arena[i] < -m || arena[i] > m)
+            corrupted ();
+    for (i = 0; i < n; i++)
+        if (arena[(i + 1 < n ? offsets[i + 1] : arena_size) - 1])
+            corrupted ();
+    NEW (clauses, n);
+    for (i = 0; i < n; i++)
+        clauses[i] = p + offsets[i];
+    p += header->lits + n;
+    for (i = 0; i < n; i++)
+        if (p[i] != length (i))		/* saved before any assignment */
+            corrupted ();
+    if (compact)
+        counters ();
+    else
+        nonfalse = p;
+    p += n;
+    counts = p + m;
+    p += 2 * m + 1;
+    occ_offsets = p + m;
+    p += 2 * m + 1;
+    occs = p;
+    for (i = 0; i < header->lits + 2 * m; i++)
+        if (occs[i] < -1 || occs[i] >= n)
+            corrupted ();
+    if (m && occs[header->lits + 2 * m - 1] != -1)
+        corrupted ();
+    NEW (lit2occs, 2 * m + 1);
+    lit2occs += m;
+    q = occs;			/* the lists follow each other as in 'connect' */
+    for (i = 1; i <= m; i++)
+        for (sign = 1; sign >= -1; sign -= 2)
+        {
+            lit = sign * i;
+            if (occs + occ_offsets[lit] != q)
+                corrupted ();
+            lit2occs[lit] = q;
+            while (*q >= 0)
+                q++;
+            if (q++ - lit2occs[lit] != counts[lit])
+                corrupted ();
+        }
+
+    NEW (trail, m);
+    NEW (assignment, m + 1);
+    next_to_propagate = top_of_trail = trail;
+    leave (LOAD);
+
+    msg ("loaded snapshot p cnf %d %d with %d literals", m, n, header->lits);
+}
+
+    static int
+found_failed (int lit)
+{
+    LOG (msg ("failed literal %d", lit));
+    assign (-lit);
+    if (bcp ())
+        return 1;
+    msg ("top level propagation in round %d failed", rounds + 1);
+    inconsistent = 1;
+    return -1;
+}
+
+/* Publish a top level unit in the shared 'queue' unless its variable has
+ * already been claimed.  Returns zero if the negation was published.
+ */
+    static int
+publish (int lit)
+{
+    int var = abs (lit), prev, slot;
+    prev = __sync_val_compare_and_swap (&owner[var], 0, lit);
+    if (prev)
+        return prev == lit;
+    slot = __sync_fetch_and_add (&queued, 1);
+    assert (slot < m);
+    __atomic_store_n (&queue[slot], lit, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Exchange units with the other threads of the portfolio on the top level.
+ * First the new units on our trail are published, then the units published
+ * by others are assigned and propagated.  Returns the number of imported
+ * units or '-1' if the formula turned out to be inconsistent.
+ */
+    static int
+exchange (void)
+{
+    int lit, tmp, res = 0;
+
+    assert (!decision);
+    while (exported < top_of_trail - trail)
+        if (!publish (trail[exported++]))
+            goto INCONSISTENT;
+
+    while (imported < __atomic_load_n (&queued, __ATOMIC_ACQUIRE))
+    {
+        if (!(lit = __atomic_load_n (&queue[imported], __ATOMIC_ACQUIRE)))
+            break;		/* slot reserved but not written yet */
+        imported++;
+        if ((tmp = val (lit)) > 0)
+            continue;
+        if (tmp < 0)
+            goto INCONSISTENT;
+        assign (lit);
+        res++;
+    }
+
+    if (!res)
+        return 0;
+    if (bcp ())
+        return res;
+INCONSISTENT:
+    msg ("worker %d: imported units inconsistent", worker_id);
+    inconsistent = 1;
+    return -1;
+}
+
+/* One round of probing each unassigned variable in both phases from the
+ * top level.  Returns '1' if a failed literal was found, '0' if not and
+ * '-1' if probing has to stop, because the formula turned out to be
+ * inconsistent or the budget is exhausted.
+ */
+    static int
+flat (void)
+{
+    int i, lit, var, first, failed, imports, changed = 0;
+
+    for (i = 0; i < m; i++)
+    {
+        if (portfolio && (imports = exchange ()))
+        {
+            if (imports < 0)
+                return -1;
+            changed = 1;
+        }
+
+        first = schedule[i];
+        var = abs (first);
+        if (val (var))
+            continue;
+
+        if (exhausted ())
+            return -1;
+
+        lit = first;
+        decide (lit);
+        failed = !bcp ();
+        backtrack ();
+        if (!failed)
+        { 
+            lit = -first;
+            decide (lit);
+            failed = !bcp ();
+            backtrack ();
+        }
+        if (failed)
+        {
+            changed = 1;
+            if (found_failed (lit) < 0)
+                return -1;
+        }
+    }
+
+    return changed;
+}
+
+/* Save for the nodes 'i', 'i+1', ... up to the end of the current tree
+ * whether they are assigned on the top level.  This is only called on the
+ * top level and the top level does not change while a tree is traversed,
+ * except after a failed literal.
+ */
+    static void
+fix (int i)
+{
+    int tmp;
+    assert (!level);
+    while (i < ntree)
+    {
+        tmp = val (tree_lits[i]);
+        tree_fixed[i] = (tmp > 0) - (tmp < 0);
+        if (++i < ntree && !tree_depths[i])
+            break;
+    }
+}
+
+/* Visit the nodes of the probing forest in preorder.  Before a node at
+ * depth 'd' is probed all levels above 'd' are popped, thus the trail
+ * contains exactly the propagated ancestors of the node, which are kept in
+ * 'path'.  If the node literal is already true there is nothing to
+ * propagate and an empty level is opened.  If it is false, but not on the
+ * top level, then it implies its negation through its ancestors and is
+ * failed too.  The subtree of a node false on the top level is skipped,
+ * since all its descendants are false on the top level too.  This also
+ * applies to a failed literal after its negation has been propagated on
+ * the top level.  Then the ancestors are decided again.  If one of them
+ * turns out to be false or failed now, its subtree is skipped and probed
+ * in the next round, which is guaranteed to happen.  Returns the same as
+ * 'flat'.
+ */
+    static int
+tree_round (void)
+{
+    int i, k, lit, other, depth, tmp, skip = -1, changed = 0;
+
+    for (i = 0; i < ntree; i++)
+    {
+        lit = tree_lits[i];
+        depth = tree_depths[i];
+        if (skip >= 0)
+        {
+            if (depth > skip)
+                continue;
+            skip = -1;
+        }
+
+        if (level > depth)
+            ascend (depth);
+
+        if (!depth)
+            fix (i);
+
+        if (tree_fixed[i] < 0)
+        {
+            skip = depth;
+            continue;
+        }
+
+        path[depth] = lit;
+        tmp = val (lit);
+        if (tmp > 0)
+        {
+            descend (0);
+            continue;
+        }
+
+        if (!tmp)
+        {
+            if (exhausted ())
+            {
+                if (level)
+                    ascend (0);
+                return -1;
+            }
+            descend (lit);
+            if (bcp ())
+                continue;
+        }
+
+        if (level)
+            ascend (0);
+        changed = 1;
+        if (found_failed (lit) < 0)
+            return -1;
+        fix (i + 1);
+
+        skip = depth;
+        for (k = 0; k < depth; k++)
+        {
+            other = path[k];
+            tmp = val (other);
+            if (tmp > 0)
+            {
+                descend (0);
+                continue;
+            }
+            if (!tmp)
+            {
+                descend (other);
+                if (bcp ())
+                    continue;
+                ascend (k);
+            }
+            skip = k;
+            break;
+        }
+    }
+
+    if (level)
+        ascend (0);
+
+    return changed;
+}
+
+/* Remove the learned clause '-x | y' if 'y' is reachable from 'x' in the
+ * binary implication graph without using this clause.  The search visits
+ * learned implications and original binary clauses over unassigned
+ * literals and gives up after 'REDUCE_STEPS' steps.  Uses the parse
+ * 'stack' as queue.
+ */
+#define REDUCE_STEPS 1000
+
+    static int
+reachable (int x, int y, char * mark)
+{
+    int * q, * p, lit, other, steps = 0, res = 0, i, h;
+
+    assert (empty ());
+    push (x);
+    mark[x] = 1;
+    for (h = 0; !res && stack + h < top_of_stack && steps < REDUCE_STEPS; h++)
+    {
+        lit = stack[h];
+        for (i = 0; i < nimpls[lit] && !res; i++)
+        {
+            other = impls[lit][i];
+            steps++;
+            if (!other || val (other) || mark[other])
+                continue;
+            res = (other == y);
+            mark[other] = 1;
+            push (other);
+        }
+        for (p = lit2occs[-lit]; !res && *p >= 0; p++)
+        {
+            q = clauses[*p];
+            steps++;
+            if (!q[1] || q[2])
+                continue;
+            other = (q[0] == -lit) ? q[1] : q[0];
+            if (val (other) || mark[other])
+                continue;
+            res = (other == y);
+            mark[other] = 1;
+            push (other);
+        }
+    }
+
+    for (p = stack; p < top_of_stack; p++)
+        mark[*p] = 0;
+    top_of_stack = stack;
+    return res;
+}
+
+    static void
+erase (int from, int to)
+{
+    int i;
+    for (i = 0; i < nimpls[from]; i++)
+        if (impls[from][i] == to)
+        {
+            impls[from][i] = 0;
+            return;
+        }
+}
+
+    static void
+reduce (void)
+{
+    int i, a, b;
+    char * mark;
+
+    NEW (mark, 2 * m + 1);
+    mark += m;
+    for (i = 0; i < nlearned; i++)
+    {
+        a = learned[2 * i];
+        b = learned[2 * i + 1];
+        if (val (a) || val (b))
+            continue;
+        erase (-a, b);
+        erase (-b, a);
+        if (reachable (-a, b, mark))
+        {
+            learned[2 * i] = learned[2 * i + 1] = 0;
+            reduced++;
+        }
+        else
+        {
+            imply (-a, b);
+            imply (-b, a);
+        }
+    }
+    free (mark - m);
+    msg ("removed %d of %d hyper binary resolvents transitively",
+            reduced, nlearned);
+}
+
+/* The probing order of thread 'id' in the portfolio.
+*/
+    static int
+order_of (int id)
+{
+    int res;
+    if (!id)
+        return order;
+    if (id >= ORDERS)
+        return RANDOM_ORDER;
+    res = id - 1;
+    if (res >= order)
+        res++;
+    return res;
+}
+
     static void
 process (void)
 {
-    int i, * clause, lit, tmp, var, changed, failed;
+    int i, * clause, lit, tmp, res;
+    double delta;
 
     for (i = 0; i < n; i++)
     {
@@ -565,42 +1697,94 @@ process (void)
     }
 
     do {
-        changed = 0;
-        for (var = 1; var <= m; var++)
+        if (round_limit >= 0 && rounds >= round_limit)
         {
-            if (val (var))
-                continue;
-
-            lit = var;
-            decide (lit);
-            failed = !bcp ();
-            backtrack ();
-            if (failed)
-            {
-FOUND_FAILED_LITERAL:
-                changed = 1;
-                LOG (msg ("failed literal %d", lit));
-                assign (-lit);
-                if (!bcp ())
-                {
-                    msg ("top level propagation in round %d failed", rounds);
-                    inconsistent = 1;
-                    return;
-                }
-            }
-            else
-            { 
-                lit = -var;
-                decide (lit);
-                failed = !bcp ();
-                backtrack ();
-                if (failed)
-                    goto FOUND_FAILED_LITERAL;
-            }
+            msg ("round limit %d reached", round_limit);
+            limited = 1;
+            return;
+        }
+        enter (PROBE);
+        res = tree ? tree_round () : flat ();
+        delta = leave (PROBE);
+        if (!res && portfolio)
+            res = exchange ();
+        if (res < 0)
+            return;
+        if (profiling)
+        {
+            round_times = realloc (round_times, (rounds + 1) * sizeof *round_times);
+            round_times[rounds] = delta;
         }
         rounds++;
-        msg ("%d units after round %d", units, rounds);
-    } while (changed);
+        if (portfolio)
+            msg ("worker %d: %d units after round %d",
+                    worker_id, units, rounds);
+        else
+            msg ("%d units after round %d", units, rounds);
+    } while (res);
+
+    if (portfolio && __sync_bool_compare_and_swap (&winner, -1, worker_id))
+    {
+        msg ("worker %d with %s order reached fixpoint first",
+                worker_id, order_names[order_of (worker_id)]);
+        stop = 1;
+    }
+}
+
+/* Run 'process' in a portfolio thread on its own copy of the mutable
+ * state and add its statistics to the totals.
+ */
+    static void *
+worker (void * arg)
+{
+    worker_id = (int) (long) arg;
+    init_counters ();
+    NEW (trail, m);
+    NEW (assignment, m + 1);
+    next_to_propagate = top_of_trail = trail;
+    sched (order_of (worker_id), seed + worker_id);
+    process ();
+    if (!inconsistent)
+        exchange ();
+    msg ("worker %d: %d rounds, %d decisions, %lld propagations",
+            worker_id, rounds, decisions, propagations);
+    __sync_fetch_and_add (&others_decisions, decisions);
+    __sync_fetch_and_add (&others_propagations, propagations);
+    free (nonfalse);
+    free (nonfalse8);
+    free (nonfalse16);
+    free (trail);
+    free (assignment);
+    free (schedule);
+    free (round_times);
+    return 0;
+}
+
+/* Start the other threads of the portfolio and run thread '0' in the main
+ * thread.  At the end all published units are imported by thread '0',
+ * which gives the fixpoint if one was reached.
+ */
+    static void
+run_portfolio (void)
+{
+    pthread_t * threads;
+    long i;
+
+    NEW (queue, m);
+    NEW (owner, m + 1);
+    NEW (threads, threadNum);
+    for (i = 1; i < threadNum; i++)
+        if (pthread_create (threads + i, 0, worker, (void *) i))
+            die ("can not create thread %ld", i);
+    process ();
+    for (i = 1; i < threadNum; i++)
+        pthread_join (threads[i], 0);
+    free (threads);
+
+    if (!inconsistent)
+        exchange ();
+    decisions += others_decisions;
+    propagations += others_propagations;
 }
 
     static void
@@ -611,57 +1795,244 @@ stats (void)
     msg ("%d units, %d rounds, %d decisions, %lld propagations", 
             units, rounds, decisions, propagations);
     msg ("%.1f million propagations per second", (t > 0 ? p / t : 0));
+    msg ("%.1f MB maximum resident set size", max_rss () / 1024.0);
+    if (hbr)
+        msg ("%d hyper binary resolvents, %d removed", hbrs, reduced);
+}
+
+/* Writes 'str' as a JSON string literal, with quotes, backslashes and
+ * control characters escaped.
+ */
+    static void
+json_string (FILE * file, const char * str)
+{
+    const unsigned char * c;
+
+    fputc ('"', file);
+    for (c = (const unsigned char *) str; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            fprintf (file, "\\%c", *c);
+        else if (*c < 0x20)
+            fprintf (file, "\\u%04x", *c);
+        else
+            fputc (*c, file);
+    }
+    fputc ('"', file);
+}
+
+    static void
+profile (void)
+{
+    FILE * file;
+    int i, last;
+    struct phase * p;
+
+    if (!strcmp (profile_name, "-"))
+        file = stderr;
+    else if (!(file = fopen (profile_name, "w")))
+        die ("can not write profile '%s'", profile_name);
+
+    fprintf (file, "{\n");
+    fprintf (file, "  \"input\": ");
+    json_string (file, input_name);
+    fprintf (file, ",\n");
+    fprintf (file, "  \"variables\": %d,\n", m);
+    fprintf (file, "  \"clauses\": %d,\n", n);
+    fprintf (file, "  \"threads\": %d,\n", threadNum);
+    fprintf (file, "  \"units\": %d,\n", units);
+    fprintf (file, "  \"rounds\": %d,\n", rounds);
+    fprintf (file, "  \"decisions\": %d,\n", decisions);
+    fprintf (file, "  \"propagations\": %lld,\n", propagations);
+    fprintf (file, "  \"limited\": %s,\n", limited ? "true" : "false");
+    fprintf (file, "  \"wall\": %.6f,\n", wall () - start_time);
+    fprintf (file, "  \"process\": %.6f,\n", seconds ());
+    fprintf (file, "  \"max_rss_kb\": %ld,\n", max_rss ());
+    fprintf (file, "  \"phases\": {\n");
+    for (i = 0; i < PHASES; i++)
+    {
+        p = phases + i;
+        fprintf (file, "    ");
+        json_string (file, phase_names[i]);
+        fprintf (file, ": { \"calls\": %lld, \"seconds\": %.6f",
+                p->calls, p->time);
+        if (cycles)
+            fprintf (file, ", \"cycles\": %llu", p->cycles);
+        fprintf (file, " }%s\n", i + 1 < PHASES ? "," : "");
+    }
+    fprintf (file, "  },\n");
+    fprintf (file, "  \"round_seconds\": [");
+    for (i = 0; i < rounds; i++)
+        fprintf (file, "%s%.6f", i ? ", " : "", round_times[i]);
+    fprintf (file, "],\n");
+    for (last = HISTO - 1; last > 0 && !histo[last]; last--)
+        ;
+    fprintf (file, "  \"occs_histogram\": [\n");
+    for (i = 0; i <= last; i++)
+        fprintf (file, "    { \"min\": %lld, \"max\": %lld, \"count\": %lld }%s\n",
+                i ? 1ll << (i - 1) : 0ll, i ? (1ll << i) - 1 : 0ll,
+                histo[i], i < last ? "," : "");
+    fprintf (file, "  ]\n}\n");
+
+    if (file != stderr)
+        fclose (file);
+    msg ("wrote profile to %s", profile_name);
 }
 
     static void
 release (void)
 {
     int i;
-    for (i = 0; i < n; i++)
-        free (clauses[i]);
+    if (mapped)
+        munmap (mapped, mapped_size);
+    else
+    {
+        free (arena);
+        free (nonfalse);
+        free (counts - m);
+        free (occs);
+    }
+    if (compact)
+    {
+        free (nonfalse8);
+        free (nonfalse16);
+        if (mapped)
+            free (nonfalse);
+    }
     free (clauses);
-    free (nonfalse);
-    free (counts - m);
     free (lit2occs - m);
-    free (occs);
     free (assignment);
     free (trail);
     free (stack);
+    free (schedule);
+    free (round_times);
+    free (tree_lits);
+    free (tree_depths);
+    free (tree_fixed);
+    if (impls)
+    {
+        for (i = -m; i <= m; i++)
+            free (impls[i]);
+        free (impls - m);
+        free (nimpls - m);
+        free (simpls - m);
+    }
+    free (learned);
+    free (path);
+    free (control);
+    free (queue);
+    free (owner);
 }
 
-int threadNum = 1;
+    static void
+usage (void)
+{
+    printf (
+"usage: sflprepc [ <option> ... ] [ <input> [ <output> ] ]\n"
+"\n"
+"where <input> is a DIMACS file or a snapshot written with '--snapshot'\n"
+"\n"
+"where <option> is one of the following\n"
+"\n"
+"  -h                 print this command line option summary\n"
+"  -p <num>           number of threads (default 1)\n"
+"  --time=<sec>       wall clock budget, print formula simplified so far\n"
+"  --props=<num>      budget on number of propagations (of all threads)\n"
+"  --rounds=<num>     budget on number of probing rounds\n"
+"  --order=natural    probe variables in index order (default)\n"
+"  --order=occs       probe variables with most occurrences first\n"
+"  --order=random     probe variables in random order\n"
+"  --seed=<num>       seed for random order (default 0)\n"
+"  --portfolio        run '-p' threads with different orders sharing units\n"
+"  --tree             share propagation along binary implication trees\n"
+"  --hbr              add hyper binary resolvents found during probing\n"
+"  --compact          use 8 or 16 bit clause counters if possible\n"
+"  --profile=<file>   write per phase timing profile in JSON to <file>\n"
+"  --cycles           also measure time stamp counter cycles per phase\n"
+"  --snapshot=<file>  write binary snapshot of connected formula to <file>\n");
+}
+
+/* Returns the value of the long option 'arg' if it has the form
+ * '--<name>=<value>' and zero otherwise.
+ */
+    static const char *
+option (const char * arg, const char * name)
+{
+    size_t len = strlen (name);
+    if (arg[0] != '-' || arg[1] != '-' || strncmp (arg + 2, name, len))
+        return 0;
+    if (arg[len + 2] != '=')
+        return 0;
+    return arg + len + 3;
+}
 
     int
 main (int argc, char ** argv)
 {
     int i, close_input = 0, close_output = 0;
+    const char * val;
 
-    /*for (i = 2; i <= argc; i++)*/
-    /*{*/
-        /*if (strcmp (argv[1], "-p"))*/
-        /*{*/
-            /*printf ("usage: sflprepc -p num [ <input> [ <output> ]]\n");*/
-            /*exit (0);*/
-        /*}*/
-
-        /*[>if (output_name)<]*/
-            /*[>die ("too many command line options");<]*/
-        /*if (threadNum == 1) */
-            /*threadNum = atoi(argv[i]);*/
-        /*else {*/
-        /*if (input_name)*/
-            /*output_name = argv[i];*/
-        /*else*/
-            /*input_name = argv[i];*/
-        /*}*/
-    /*}*/
-    
-    if (strcmp (argv[1], "-p") || argc > 5 || argc < 3)
-        printf("usage: sflprepc -p num  [<input> [ <output> ]]\n");
-    threadNum   = atoi(argv[2]);
-    input_name  = argv[3];
-    output_name = argv[4];
-    
+    start_time = wall ();
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp (argv[i], "-h"))
+        {
+            usage ();
+            exit (0);
+        }
+        else if (!strcmp (argv[i], "-p"))
+        {
+            if (++i == argc)
+                die ("argument to '-p' missing");
+            if ((threadNum = atoi (argv[i])) <= 0)
+                die ("invalid number of threads '%s'", argv[i]);
+        }
+        else if ((val = option (argv[i], "time")))
+            time_limit = atof (val);
+        else if ((val = option (argv[i], "props")))
+            propagation_limit = atoll (val);
+        else if ((val = option (argv[i], "rounds")))
+            round_limit = atoi (val);
+        else if ((val = option (argv[i], "profile")))
+            profile_name = val, profiling = 1;
+        else if (!strcmp (argv[i], "--cycles"))
+            cycles = 1;
+        else if (!strcmp (argv[i], "--tree"))
+            tree = 1;
+        else if (!strcmp (argv[i], "--hbr"))
+            hbr = 1;
+        else if (!strcmp (argv[i], "--compact"))
+            compact = 1;
+        else if (!strcmp (argv[i], "--portfolio"))
+            portfolio = 1;
+        else if ((val = option (argv[i], "seed")))
+            seed = strtoull (val, 0, 10);
+        else if ((val = option (argv[i], "snapshot")))
+            snapshot_name = val;
+        else if ((val = option (argv[i], "order")))
+        {
+            if (!strcmp (val, "natural"))
+                order = NATURAL_ORDER;
+            else if (!strcmp (val, "occs"))
+                order = OCCS_ORDER;
+            else if (!strcmp (val, "random"))
+                order = RANDOM_ORDER;
+            else
+                die ("invalid order '%s'", val);
+        }
+        else if (argv[i][0] == '-' && argv[i][1])
+            die ("invalid option '%s' (try '-h')", argv[i]);
+        else if (output_name)
+            die ("too many arguments (try '-h')");
+        else if (input_name)
+            output_name = argv[i];
+        else
+            input_name = argv[i];
+    }
+
+    if (portfolio && (tree || hbr))
+        die ("'--portfolio' can not be combined with '--tree' or '--hbr'");
 
     if (input_name && strcmp (input_name, "-"))
     {
@@ -676,14 +2047,39 @@ main (int argc, char ** argv)
         input_name = "<stdin>";
     }
 
-    parse ();
-    connect ();
+    if (is_snapshot ())
+        load ();
+    else
+    {
+        parse ();
+        connect ();
+    }
 
     if (close_input)
         fclose (input);
 
+    if (snapshot_name)
+        save ();
+
     omp_set_num_threads(threadNum);
-    process ();
+    sched (order, seed);
+    if (tree)
+        forest ();
+    if (hbr)
+    {
+        NEW (impls, 2 * m + 1);
+        NEW (nimpls, 2 * m + 1);
+        NEW (simpls, 2 * m + 1);
+        impls += m;
+        nimpls += m;
+        simpls += m;
+    }
+    if (portfolio)
+        run_portfolio ();
+    else
+        process ();
+    if (hbr && !inconsistent)
+        reduce ();
     stats ();
 
     if (output_name && strcmp (output_name, "-"))
@@ -711,6 +2107,9 @@ main (int argc, char ** argv)
     if (close_output)
         fclose (output);
 
+    if (profiling)
+        profile ();
+
     release ();
 
     return 0;